@@ -0,0 +1,38 @@
+'
+' s = s + expr appends to the string in place
+'
+
+s = "a"
+s = s + "b"
+s = s + "c" + "d"
+s = s + s
+print s
+n = "1"
+n = n + 2
+print n
+n = "1"
+n = n + 2 + "x"
+print n
+t = "q"
+t = t + 1.5
+print t
+func f()
+  s = "reset"
+  f = "!"
+end
+s = s + "-" + f()
+print s
+u = "x"
+u = u + chr(65) + str(12) + (u + "y")
+print u
+z = ""
+for i = 1 to 10
+  z = z + i
+next
+print z
+s = "12"
+s = s + 3
+print s
+s = "x"
+s = s + s + s
+print s, len(s)
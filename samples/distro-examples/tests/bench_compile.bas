@@ -0,0 +1,41 @@
+'
+' compile time benchmark
+'
+' CHAIN compiles generated programs of increasing size. the time per
+' block should stay flat as the program grows
+'
+
+sub add_blocks(byref src, n)
+  local i
+  for i = 1 to n
+    src << "if a" + i + " > 1 then"
+    src << "  for j = 1 to 2"
+    src << "    while k < 1"
+    src << "      k = k + 1"
+    src << "    wend"
+    src << "    select case j"
+    src << "    case 1"
+    src << "      b = 1"
+    src << "    case else"
+    src << "      b = 2"
+    src << "    end select"
+    src << "  next"
+    src << "elif a" + i + " < 0 then"
+    src << "  repeat: k = k - 1: until k < 0"
+    src << "else"
+    src << "  try: b = 0: catch e: b = 1: end try"
+    src << "endif"
+  next
+end
+
+n = 500
+for pass = 1 to 5
+  dim src
+  src << "end"
+  add_blocks src, n
+  st = ticks
+  chain src
+  et = ticks - st
+  ? n; " blocks "; len(src); " lines: "; et; " ms "; round(et * 1000 / n, 2); " us/block"
+  n = n * 2
+next
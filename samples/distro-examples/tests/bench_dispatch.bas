@@ -0,0 +1,54 @@
+'
+' bytecode dispatch throughput benchmark
+'
+' compare builds configured with and without --disable-computed-goto
+'
+
+const n = 2000000
+
+sub report(name, st, stmts)
+  local et = ticks - st
+  if et == 0 then et = 1
+  ? name; ": "; et; " ms "; round(stmts / (et / 1000)); " stmt/s"
+end
+
+st = ticks
+for i = 1 to n: next
+report "FOR", st, n
+
+st = ticks
+i = 0
+while i < n: i = i + 1: wend
+report "WHILE", st, n * 3
+
+st = ticks
+i = 0
+repeat: i = i + 1: until i >= n
+report "REPEAT", st, n * 3
+
+st = ticks
+s = 0
+for i = 1 to n
+  s = s + i * 2 - 1
+  if s > 100000 then s = 0
+next
+report "ARITH", st, n * 3
+
+st = ticks
+dim a(1000)
+for i = 1 to n
+  a(i mod 1000) = a((i + 1) mod 1000) + 1
+next
+report "ARRAY", st, n * 2
+
+func fib(x)
+  if x < 2 then
+    fib = x
+  else
+    fib = fib(x - 1) + fib(x - 2)
+  endif
+end
+
+st = ticks
+f = fib(24)
+report "FIB", st, 75025 * 3
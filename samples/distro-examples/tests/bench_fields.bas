@@ -0,0 +1,64 @@
+'
+' map access benchmark
+'
+' each obj.field site resolves the field through a per-site cache,
+' FOR k IN m visits the keys by position
+'
+
+const n = 1000000
+
+sub report(name, st)
+  local et = ticks - st
+  if et == 0 then et = 1
+  ? name; ": "; et; " ms"
+end
+
+obj.x = 0
+obj.y = 0
+obj.name = "point"
+obj.pos.left = 0
+obj.pos.top = 0
+
+st = ticks
+for i = 1 to n
+  obj.x = obj.x + 1
+next
+report "READ/WRITE", st
+
+st = ticks
+for i = 1 to n
+  obj.pos.left = obj.pos.top + i
+next
+report "NESTED", st
+
+dim pts(100)
+for i = 0 to 100
+  pts(i).x = i
+  pts(i).y = i * 2
+next
+st = ticks
+s = 0
+for j = 1 to n / 100
+  for i = 0 to 100
+    s = s + pts(i).x + pts(i).y
+  next
+next
+report "ARRAY OF MAPS", st
+
+st = ticks
+for i = 1 to n
+  a = obj
+  a.x = i
+next
+report "COPY ON WRITE", st
+
+m = {}
+for i = 1 to 100000
+  m("k" + i) = i
+next
+st = ticks
+s = 0
+for k in m
+  s = s + 1
+next
+report "FOR IN 100K KEYS", st
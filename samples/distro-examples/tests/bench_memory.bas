@@ -0,0 +1,50 @@
+'
+' memory benchmark for arrays and maps of scalars
+'
+' reports the growth in resident memory per element. reads
+' /proc/self/status so only works on linux
+'
+
+const n = 1000000
+
+func rss
+  local ln, i, kb = 0
+  open "/proc/self/status" for input as #1
+  for i = 1 to 60
+    line input #1, ln
+    if left(ln, 6) == "VmRSS:" then
+      kb = val(mid(ln, 7))
+      exit for
+    endif
+  next
+  close #1
+  return kb
+end
+
+sub report(name, kb)
+  ? name; ": "; kb; " kB "; round(kb * 1024 / n, 1); " bytes/element"
+end
+
+base = rss
+dim a(n - 1)
+for i = 0 to n - 1: a(i) = i: next
+report "ARRAY INTEGER", rss - base
+
+base = rss
+dim b(n - 1)
+for i = 0 to n - 1: b(i) = i / 3: next
+report "ARRAY REAL", rss - base
+
+base = rss
+c = {}
+for i = 0 to n - 1: c[i] = i: next
+report "MAP INTEGER", rss - base
+
+base = rss
+d = []
+for i = 0 to n - 1: d << i: next
+report "APPEND INTEGER", rss - base
+
+base = rss
+dim e(999, 999)
+report "DIM 1000x1000", rss - base
@@ -0,0 +1,53 @@
+'
+' constant expressions folded by the compiler must match the run-time result
+'
+two = 2
+three = 3
+neg = -7.5
+
+sub expect(a, b, msg)
+  if (a != b) then
+    print "FAIL: "; msg; " "; a; " != "; b
+  endif
+end
+
+expect 1 + 2 * 3, 1 + two * three, "add/mul"
+expect (1 + 2) * 3, (1 + two) * three, "parenthesis"
+expect 2 ^ 10, two ^ 10, "pow"
+expect 7 \ 2, 7 \ two, "int div"
+expect 7 / 2, 7 / two, "div"
+expect -7.5 % 2, neg % two, "mod"
+expect -7.5 mod 2, neg mod two, "mod"
+expect -7.5 mdl 2, neg mdl two, "mdl"
+expect -(2 - 3), -(two - three), "unary minus"
+expect not 0, not (two - two), "not"
+expect ~5, ~(two + three), "inv"
+expect sqr(16), sqr(two * 8), "sqr"
+expect sin(0.5), sin(two / 4), "sin"
+expect int(2.5), int(two + 0.5), "int"
+expect len("hello"), len("hel" + "lo"), "len"
+expect chr(65), chr(60 + two + three), "chr"
+expect asc("A"), asc(chr(65 + two - two)), "asc"
+expect 5 mod 3 + 1, 5 mod three + 1, "mixed"
+
+' integer arithmetic stays integer
+print 1 + 2, 10 \ 3, 3 * 2, -4
+print 9 / 2, sqr(2) * sqr(2) = 2, chr(72) + chr(105)
+
+' side effects must not be folded
+randomize 1
+a = rnd
+b = rnd
+if (a = b) then print "FAIL: rnd folded"
+t1 = timer
+delay 1100
+t2 = timer
+if (t1 = t2) then print "FAIL: timer folded"
+
+' run-time errors are still reported at run-time
+try
+  x = 1 / 0
+  print "FAIL: no division by zero"
+catch e
+  print "division by zero caught"
+end try
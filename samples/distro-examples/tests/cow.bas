@@ -0,0 +1,85 @@
+'
+' copies of arrays and maps share storage until either is modified
+'
+
+a = [1, 2, 3]
+b = a
+b(1) = 9
+print a; " "; b
+sub modify(x)
+  x(0) = 100
+  print "in "; x
+end
+modify(a)
+print a
+func f(byref x)
+  x(2) = -1
+  f = len(x)
+end
+print f(a); " "; a
+c = [1, 2]
+c(0) = c
+print c
+d = [1]
+d << d
+print d
+e = [[1, 2], [3, 4]]
+e(1) << e
+print e
+sub by(byref el)
+  local t = el
+  el(0) = 77
+  print t; " "; el
+end
+g = [[5, 6], 1]
+by(g(0))
+print g
+m = {x: 1, y: [1, 2]}
+n = m
+n.x = 2
+n.y(0) = 99
+print m.x; m.y; " "; n.x; n.y
+h = [{k: [1]}, 2]
+k = h
+k(0).k(0) = 5
+print h; " "; k
+func Counter()
+  sub incr
+    self.v++
+  end
+  result = {}
+  result.v = 0
+  result.incr = @incr
+  return result
+end
+o = Counter()
+o2 = o
+o.incr()
+o.incr()
+o2.incr()
+print o.v; o2.v
+s = [3, 1, 2]
+t = s
+func cmp(x, y)
+  cmp = iff(x == y, 0, iff(x < y, -1, 1))
+end
+sort t use cmp(x, y)
+print s; " "; t
+u = s
+sort u
+print s; " "; u
+dim w(3) as integer
+w2 = w
+w2(1) = 4
+print w; " "; w2
+x1 = [1, [2, 3]]
+y1 = x1
+print y1(1)(0)
+y1(1)(0) = 8
+print x1; " "; y1
+p1 = {"x": 1, "in": {"y": 2}}
+p2 = p1
+print p2.x + p2.in.y
+p2.in.y = 5
+print p2.z; len(p1); len(p2)
+print p1; " "; p2
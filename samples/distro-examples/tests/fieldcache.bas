@@ -0,0 +1,74 @@
+'
+' map fields resolved through the per-site field cache
+'
+
+' the same site visiting different maps
+dim pts(3)
+for i = 0 to 3
+  pts(i).x = i * 10
+next
+for j = 1 to 2
+  for i = 0 to 3
+    print pts(i).x;" ";
+  next
+  print
+next
+
+' writes through a copy do not reach the original
+a.v = 1
+for i = 1 to 3
+  b = a
+  b.v = b.v + i
+  print a.v;" ";b.v
+next
+
+' the copy keeps its own value after the original changes
+c = a
+for i = 1 to 2
+  a.v = a.v * 5
+  print a.v;" ";c.v
+next
+
+' the variable becomes a new map
+for i = 1 to 3
+  m = 0
+  m.count = i
+  m.count = m.count + 1
+  print m.count;" ";
+next
+print
+
+' field names ignore case
+p.Name = "first"
+for i = 1 to 2
+  print p.name;" ";p.NAME
+  p.NAME = "second"
+next
+
+' nested fields
+q.inner.val = 1
+for i = 1 to 3
+  q.inner.val = q.inner.val * 2
+  r = q
+  r.inner.val = 0
+next
+print q.inner.val;" ";r.inner.val
+
+' new fields are added to a cached table
+s.a = 1
+for i = 1 to 3
+  s.a = s.a + 1
+  if i = 2 then s.b = 10
+next
+print s.a;" ";s.b;" ";len(s)
+
+func make_pt(x)
+  local pt
+  pt.x = x
+  return pt
+end
+for i = 1 to 3
+  t = make_pt(i)
+  print t.x;" ";
+next
+print
@@ -0,0 +1,52 @@
+'
+' FOR-TO-NEXT with constant and variable limits
+'
+for i = 1 to 5: print i;: next: print
+for i = 5 to 1 step -2: print i;: next: print
+for i = 0 to 1 step 0.25: print i;: next: print
+for i = 1 to 3.5: print i;: next: print
+for i = 1.5 to 4: print i;: next: print
+for i = 1 to 0: print "FAIL";: next: print "empty"
+
+' variable limit changed in the loop
+n = 10
+for i = 1 to n
+  n = 3
+  print i;
+next
+print
+
+' variable step changed in the loop
+s = 1
+for i = 1 to 20 step s
+  s = s * 2
+  print i;
+next
+print
+
+' loop variable changed in the loop
+for i = 1 to 10
+  if i = 2 then i = 8
+  print i;
+next
+print
+
+' limit is not a simple operand
+m = 2
+for i = 1 to m * 2: print i;: next: print
+
+' nested loops and exit
+c = 0
+for i = 1 to 100
+  for j = i to i + 2
+    c = c + j
+  next
+  if i = 10 then exit for
+next
+print c, i, j
+
+' final values
+for i = 1 to 3: next
+print i
+for i = 3 to 1 step -1: next
+print i
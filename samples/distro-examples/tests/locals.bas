@@ -0,0 +1,79 @@
+'
+' parameters and local variables
+'
+x = "global x"
+y = "global y"
+
+func depth(n)
+  local x
+  x = n
+  if n > 0 then
+    local r = depth(n - 1)
+    if (x != n) then print "FAIL: local overwritten by recursion"
+    return r + x
+  endif
+  return x
+end
+print depth(100)
+print x
+
+' by value and by reference parameters
+sub exchange(byref a, byref b)
+  local t = a
+  a = b
+  b = t
+end
+sub modify(a, byref b)
+  a = "changed"
+  b = "changed"
+end
+p = 1: q = 2
+exchange p, q
+print p, q
+p = "p": q = "q"
+modify p, q
+print p, q
+modify p + "!", q
+print p, q
+
+' parameter with the same name as a global
+func twice(x)
+  x = x * 2
+  return x
+end
+print twice(21), x
+
+' local in a loop goes out of scope with the loop
+sub loop_local
+  for i = 1 to 3
+    local y = i
+  next
+  print y
+end
+loop_local
+print y
+
+' local declared again in the same sub
+sub again
+  local k = 0
+  for i = 1 to 3
+    k = k + 1
+  next
+  local k
+  print "["; k; "]"
+end
+again
+
+' arguments evaluated before an error are released
+func boom(v)
+  throw "boom " + v
+end
+func pair(a, b)
+  return a + b
+end
+try
+  z = pair(1, boom(2))
+catch e
+  print e
+end try
+print pair(3, 4), x, y
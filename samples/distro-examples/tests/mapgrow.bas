@@ -0,0 +1,69 @@
+'
+' maps growing beyond their initial table
+'
+
+' keys are visited in the order they were added
+m = {}
+m.zebra = 1
+m.apple = 2
+m.mango = 3
+m("10") = 4
+m(2) = 5
+print m
+
+' growing across many slot and chunk resizes
+n = 20000
+g = {}
+for i = 1 to n
+  g("Key" + i) = i
+next
+print len(g)
+s = 0
+for i = 1 to n
+  s = s + g("KEY" + i)
+next
+print s
+print g("key1"); " "; g("kEy20000")
+
+' values found before the table grows are still in place
+g.first.value = 1
+for i = 1 to 1000
+  g("more" + i) = i
+next
+g.first.value = g.first.value + 1
+print g.first.value; " "; len(g)
+
+' a copy grows independently
+c = g
+for i = 1 to 100
+  c("copy" + i) = i
+next
+c("Key1") = -1
+print len(g); " "; len(c); " "; g("key1"); " "; c("key1")
+
+' keys ignore case but keep their first spelling
+h = {}
+h("Alpha") = 1
+h("ALPHA") = 2
+h("beta") = 3
+print h; " "; len(h)
+
+' FOR IN visits the keys by position
+for k in m
+  print k; " ";
+next
+print
+s = 0
+for k in g
+  s = s + 1
+next
+print s
+
+' keys added inside the loop are visited
+e = {}
+e.a = 1
+for k in e
+  if len(e) < 4 then e("n" + len(e)) = 1
+  print k; " ";
+next
+print
@@ -0,0 +1,92 @@
+'
+' packed INTEGER and REAL arrays
+'
+
+dim a(5) as integer
+a(1) = 2.7
+a(2) = -3
+print a
+a << 3.9
+print len(a), a(6)
+n = 4.5
+a(3) = n
+print a(3)
+sort a
+print a
+print sum(a), max(a), min(a)
+
+' reals
+dim r(2) as real
+r(0) = 1: r(1) = 2.5: r(2) = 7
+print r, sum(r), statmean(r)
+m = r * 2
+print m
+m = r + r
+print m
+
+' more dimensions
+dim b(1 to 3, 1 to 2) as integer
+b(2, 1) = 5.5
+b(3, 2) = b(2, 1) * 2
+print b
+print b(3, 2)
+
+' resize keeps the element type
+redim a(3)
+a(0) = 9.9
+print a
+insert a, 1, 8.8
+print a
+delete a, 0
+print a
+for x in a
+  print x; " ";
+next
+print
+print 8 in a
+search a, 8, idx
+print idx
+
+' copies are independent
+c = r
+c(0) = 99.5
+print r(0), c(0)
+
+' convert an existing array
+redim d(2) as real
+d(1) = 1.25
+print d
+dim e
+e << 1.9
+print e
+dim f as integer
+f << 1.9
+print f
+
+' read and write packed data
+open "packed.dat" for output as #1
+write #1, a, r
+close #1
+open "packed.dat" for input as #1
+read #1, a2, r2
+close #1
+kill "packed.dat"
+print a2, r2
+a2(0) = 4.4
+r2(0) = 4.4
+print a2(0), r2(0)
+
+' other values convert to a generic array
+a(0) = "str"
+a(1) = 2.7
+print a
+
+' a real outside the integer range converts to a generic array
+dim o(2) as integer
+o(0) = 7.9
+o(1) = 1e30
+o(2) = -1e19
+print o
+p = [1, 1e30]
+redim p(2) as integer
+print p
@@ -0,0 +1,157 @@
+'
+' superinstructions from comp_optimise() and their fallbacks
+'
+
+' LET v = v +/- int
+i = 1
+i = i + 1
+i = i - 3
+if i <> -1 then ? "ERROR int add"
+n = 1.5
+n = n + 2
+n = n - 1
+if n <> 2.5 then ? "ERROR num add"
+s = "12"
+s = s + 1
+if s <> 13 then ? "ERROR str add"
+c = 0
+for j = 1 to 10
+  c = c + 1
+next
+if c <> 10 then ? "ERROR loop add"
+
+' v +/-/cmp int in an expression
+x = 5
+y = 2
+if x + 1 <> 6 then ? "ERROR expr add"
+if (x - 1) * y <> 8 then ? "ERROR expr sub"
+if x < 5 or x > 5 or x <= 4 or x >= 6 or x <> 5 then ? "ERROR expr cmp"
+if not (x = 5) then ? "ERROR expr eq"
+x = 5.5
+if x < 5 or x = 5 or x + 1 <> 6.5 then ? "ERROR expr num"
+x = "5"
+if x <> 5 then ? "ERROR expr str"
+w = 0
+while w < 3
+  w++
+wend
+if w <> 3 then ? "ERROR while"
+
+' LET v = a(int)
+dim a(3)
+a(0) = 10
+a(1) = 1.5
+a(2) = "two"
+a(3) = [1, 2]
+e = a(0)
+if e <> 10 then ? "ERROR elem int"
+e = a(1)
+if e <> 1.5 then ? "ERROR elem num"
+e = a(2)
+if e <> "two" then ? "ERROR elem str"
+e = a(3)
+if len(e) <> 2 then ? "ERROR elem array"
+dim b(5 to 7)
+b(6) = 66
+e = b(6)
+if e <> 66 then ? "ERROR elem lbound"
+m = {}
+m(1) = "one"
+e = 0
+e = m(1)
+if e <> "one" then ? "ERROR elem map"
+
+' PRINT v
+v = 1
+print v
+v = 2.25
+print v
+v = "str"
+print v
+v = [1, 2, 3]
+print v
+
+' v + int in the arm IFF skips, across enough variables that an id byte
+' looks like an opcode
+w1 = 1
+w2 = 2
+w3 = 3
+w4 = 4
+w5 = 5
+w6 = 6
+w7 = 7
+w8 = 8
+w9 = 9
+w10 = 10
+w11 = 11
+w12 = 12
+w13 = 13
+w14 = 14
+w15 = 15
+w16 = 16
+w17 = 17
+w18 = 18
+w19 = 19
+w20 = 20
+w21 = 21
+w22 = 22
+w23 = 23
+w24 = 24
+w25 = 25
+w26 = 26
+w27 = 27
+w28 = 28
+w29 = 29
+w30 = 30
+w31 = 31
+w32 = 32
+w33 = 33
+w34 = 34
+w35 = 35
+w36 = 36
+w37 = 37
+w38 = 38
+w39 = 39
+w40 = 40
+ok = 0
+ok += (iff(1, 5, w1 + 1) = 5) + (iff(0, w1 + 1, 7) = 7) + (iff(1, w1 - 1, 0) = 0)
+ok += (iff(1, 5, w2 + 1) = 5) + (iff(0, w2 + 1, 7) = 7) + (iff(1, w2 - 1, 0) = 1)
+ok += (iff(1, 5, w3 + 1) = 5) + (iff(0, w3 + 1, 7) = 7) + (iff(1, w3 - 1, 0) = 2)
+ok += (iff(1, 5, w4 + 1) = 5) + (iff(0, w4 + 1, 7) = 7) + (iff(1, w4 - 1, 0) = 3)
+ok += (iff(1, 5, w5 + 1) = 5) + (iff(0, w5 + 1, 7) = 7) + (iff(1, w5 - 1, 0) = 4)
+ok += (iff(1, 5, w6 + 1) = 5) + (iff(0, w6 + 1, 7) = 7) + (iff(1, w6 - 1, 0) = 5)
+ok += (iff(1, 5, w7 + 1) = 5) + (iff(0, w7 + 1, 7) = 7) + (iff(1, w7 - 1, 0) = 6)
+ok += (iff(1, 5, w8 + 1) = 5) + (iff(0, w8 + 1, 7) = 7) + (iff(1, w8 - 1, 0) = 7)
+ok += (iff(1, 5, w9 + 1) = 5) + (iff(0, w9 + 1, 7) = 7) + (iff(1, w9 - 1, 0) = 8)
+ok += (iff(1, 5, w10 + 1) = 5) + (iff(0, w10 + 1, 7) = 7) + (iff(1, w10 - 1, 0) = 9)
+ok += (iff(1, 5, w11 + 1) = 5) + (iff(0, w11 + 1, 7) = 7) + (iff(1, w11 - 1, 0) = 10)
+ok += (iff(1, 5, w12 + 1) = 5) + (iff(0, w12 + 1, 7) = 7) + (iff(1, w12 - 1, 0) = 11)
+ok += (iff(1, 5, w13 + 1) = 5) + (iff(0, w13 + 1, 7) = 7) + (iff(1, w13 - 1, 0) = 12)
+ok += (iff(1, 5, w14 + 1) = 5) + (iff(0, w14 + 1, 7) = 7) + (iff(1, w14 - 1, 0) = 13)
+ok += (iff(1, 5, w15 + 1) = 5) + (iff(0, w15 + 1, 7) = 7) + (iff(1, w15 - 1, 0) = 14)
+ok += (iff(1, 5, w16 + 1) = 5) + (iff(0, w16 + 1, 7) = 7) + (iff(1, w16 - 1, 0) = 15)
+ok += (iff(1, 5, w17 + 1) = 5) + (iff(0, w17 + 1, 7) = 7) + (iff(1, w17 - 1, 0) = 16)
+ok += (iff(1, 5, w18 + 1) = 5) + (iff(0, w18 + 1, 7) = 7) + (iff(1, w18 - 1, 0) = 17)
+ok += (iff(1, 5, w19 + 1) = 5) + (iff(0, w19 + 1, 7) = 7) + (iff(1, w19 - 1, 0) = 18)
+ok += (iff(1, 5, w20 + 1) = 5) + (iff(0, w20 + 1, 7) = 7) + (iff(1, w20 - 1, 0) = 19)
+ok += (iff(1, 5, w21 + 1) = 5) + (iff(0, w21 + 1, 7) = 7) + (iff(1, w21 - 1, 0) = 20)
+ok += (iff(1, 5, w22 + 1) = 5) + (iff(0, w22 + 1, 7) = 7) + (iff(1, w22 - 1, 0) = 21)
+ok += (iff(1, 5, w23 + 1) = 5) + (iff(0, w23 + 1, 7) = 7) + (iff(1, w23 - 1, 0) = 22)
+ok += (iff(1, 5, w24 + 1) = 5) + (iff(0, w24 + 1, 7) = 7) + (iff(1, w24 - 1, 0) = 23)
+ok += (iff(1, 5, w25 + 1) = 5) + (iff(0, w25 + 1, 7) = 7) + (iff(1, w25 - 1, 0) = 24)
+ok += (iff(1, 5, w26 + 1) = 5) + (iff(0, w26 + 1, 7) = 7) + (iff(1, w26 - 1, 0) = 25)
+ok += (iff(1, 5, w27 + 1) = 5) + (iff(0, w27 + 1, 7) = 7) + (iff(1, w27 - 1, 0) = 26)
+ok += (iff(1, 5, w28 + 1) = 5) + (iff(0, w28 + 1, 7) = 7) + (iff(1, w28 - 1, 0) = 27)
+ok += (iff(1, 5, w29 + 1) = 5) + (iff(0, w29 + 1, 7) = 7) + (iff(1, w29 - 1, 0) = 28)
+ok += (iff(1, 5, w30 + 1) = 5) + (iff(0, w30 + 1, 7) = 7) + (iff(1, w30 - 1, 0) = 29)
+ok += (iff(1, 5, w31 + 1) = 5) + (iff(0, w31 + 1, 7) = 7) + (iff(1, w31 - 1, 0) = 30)
+ok += (iff(1, 5, w32 + 1) = 5) + (iff(0, w32 + 1, 7) = 7) + (iff(1, w32 - 1, 0) = 31)
+ok += (iff(1, 5, w33 + 1) = 5) + (iff(0, w33 + 1, 7) = 7) + (iff(1, w33 - 1, 0) = 32)
+ok += (iff(1, 5, w34 + 1) = 5) + (iff(0, w34 + 1, 7) = 7) + (iff(1, w34 - 1, 0) = 33)
+ok += (iff(1, 5, w35 + 1) = 5) + (iff(0, w35 + 1, 7) = 7) + (iff(1, w35 - 1, 0) = 34)
+ok += (iff(1, 5, w36 + 1) = 5) + (iff(0, w36 + 1, 7) = 7) + (iff(1, w36 - 1, 0) = 35)
+ok += (iff(1, 5, w37 + 1) = 5) + (iff(0, w37 + 1, 7) = 7) + (iff(1, w37 - 1, 0) = 36)
+ok += (iff(1, 5, w38 + 1) = 5) + (iff(0, w38 + 1, 7) = 7) + (iff(1, w38 - 1, 0) = 37)
+ok += (iff(1, 5, w39 + 1) = 5) + (iff(0, w39 + 1, 7) = 7) + (iff(1, w39 - 1, 0) = 38)
+ok += (iff(1, 5, w40 + 1) = 5) + (iff(0, w40 + 1, 7) = 7) + (iff(1, w40 - 1, 0) = 39)
+print ok
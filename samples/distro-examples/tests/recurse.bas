@@ -0,0 +1,24 @@
+'
+' non-tail recursion nested on the C stack, through a FUNC in an
+' expression and through a map method
+'
+func f(n)
+ if n = 0 then
+  f = 0
+ else
+  f = 1 + f(n - 1)
+ endif
+end
+
+func rec(n)
+ if n = 0 then
+  rec = 0
+ else
+  rec = 1 + self.rec(n - 1)
+ endif
+end
+
+print f(1000)
+m = {}
+m.rec = @rec
+print m.rec(1000)
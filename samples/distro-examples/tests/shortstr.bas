@@ -0,0 +1,74 @@
+'
+' short strings are held inside the variable, longer ones are allocated
+'
+
+' lengths either side of the inline limit
+s = ""
+for i = 1 to 20
+  s = s + chr(96 + i)
+  if len(s) != i then throw "append length " + i
+next
+? s
+
+' append of itself, inline and allocated
+a = "abc"
+a = a + a
+b = "0123456789abc"
+b = b + b
+? a, b, len(b)
+
+' copies are independent
+c = "short"
+d = c
+d = d + "er"
+? c, d
+
+' array elements and maps
+dim e(3)
+for i = 0 to 3: e(i) = string(i * 6 + 1, "x"): next
+f = e
+f(1) = "changed"
+? e
+? f
+m = {}
+for i = 1 to 5
+  m(chr(64 + i)) = left("abcdefghijklmnopqrstu", i * 4)
+next
+? m
+
+' string functions
+t = "the quick brown fox jumps"
+? mid(t, 5, 5); "|"; right(t, 5); "|"; left(t, 3); "|"; chr(33)
+? mid(t, 1, 15); "|"; mid(t, 1, 16); "|"; right(t, 16)
+? upper(mid(t, 5)); "|"; lcase("ABC")
+
+' split and join
+split "a,bb,ccc,dddddddddddddddddd", ",", g
+join g, "+", h
+? h, len(g(3))
+
+' byref
+sub grow(byref x)
+  x = x + "-grown-beyond-inline"
+end
+k = "tiny"
+grow k
+? k
+
+' swap and compare
+p = "alpha"
+q = "a much longer string value"
+swap p, q
+? p; "|"; q; "|"; (q < p); "|"; ("abc" == left("abcdef", 3))
+
+' file round trip
+w1 = "inline"
+w2 = "this one is allocated"
+open "shortstr.dat" for output as #1
+write #1, w1, w2
+close #1
+open "shortstr.dat" for input as #1
+read #1, r1, r2
+close #1
+kill "shortstr.dat"
+? r1; "|"; r2
@@ -7,3 +7,11 @@ sprint out; using "[ !!! ] "; buffer
 
 sprint out; using "(\\              \\)"; "hello down there ..."
 ? out
+
+sprint out; "a"; 1; 2.5; "b"; [1, "two", [3]]
+? out; " "; len(out)
+
+dim big(10000)
+for i = 0 to 10000: big(i) = i mod 10: next
+sprint out; big; "!"
+? len(out); " "; left(out, 8); " "; right(out, 6)
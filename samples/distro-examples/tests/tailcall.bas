@@ -0,0 +1,89 @@
+'
+' tail calls and deep recursion
+'
+
+' self recursion in tail position runs in constant stack
+func count(n, acc)
+  if n = 0 then return acc
+  return count(n - 1, acc + 1)
+end
+print count(200000, 0)
+
+' mutual recursion
+func is_even(n)
+  if n = 0 then return 1
+  return is_odd(n - 1)
+end
+func is_odd(n)
+  if n = 0 then return 0
+  return is_even(n - 1)
+end
+print is_even(100001), is_odd(100001)
+
+func gcd(a, b)
+  if b = 0 then return a
+  return gcd(b, a mod b)
+end
+print gcd(1071, 462)
+
+' tail call from inside a block with locals
+func walk(n, acc)
+  local a = [n, n * 2]
+  local s = "x" + str(n)
+  if n = 0 then return acc
+  for i = 1 to 3
+    if i = 2 then return walk(n - 1, acc + a[1] + len(s))
+  next
+end
+print walk(5000, 0)
+
+' local variable passed as an argument
+func local_arg(n, acc)
+  local k = acc + 2
+  if n = 0 then return acc
+  return local_arg(n - 1, k)
+end
+print local_arg(22, 0)
+
+' BYREF parameters use a normal call
+sub incr(byref x)
+  x = x + 1
+end
+func byr(byref v, n)
+  if n = 0 then return v
+  incr v
+  return byr(v, n - 1)
+end
+z = 0
+print byr(z, 100), z
+
+' a tail call inside TRY is a normal call
+func guarded(n)
+  if n = 0 then return "done"
+  try
+    return guarded(n - 1)
+  catch e
+    return "caught"
+  end try
+end
+print guarded(10)
+
+' calling a different function
+func small(n)
+  return "small"
+end
+func wrap(n)
+  if n > 0 then return small(n)
+  return "none"
+end
+print wrap(1)
+
+' deep non-tail SUB recursion grows the executor stack
+sub descend(n)
+  if n > 0 then
+    descend(n - 1)
+  else
+    print "bottom"
+  endif
+end
+descend(100000)
@@ -0,0 +1,18 @@
+'
+' TIMER handlers
+'
+
+n = 0
+func tick()
+  n++
+  tick = n
+end
+
+timer 5, tick
+st = ticks
+while n < 3 and ticks - st < 5000
+  a = 1
+wend
+
+if n < 3 then print "FAIL: timer handler not called"
+print "handler calls >= 3: "; n >= 3
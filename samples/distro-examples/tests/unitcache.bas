@@ -0,0 +1,39 @@
+'
+' a rebuilt unit is imported again by the same process
+'
+const UNIT_FILE = "ucunit.bas"
+
+dim main_code
+main_code << "import ucunit"
+main_code << "print ucunit.v()"
+
+sub write_unit(value)
+  open UNIT_FILE for output as #1
+  print #1, "unit ucunit"
+  print #1, "export v"
+  print #1, "func v"
+  print #1, "  v = \"" + value + "\""
+  print #1, "end"
+  close #1
+end
+
+' the delays keep the unit binary and its source in different seconds, a
+' unit is only rebuilt when its source is newer than the binary
+write_unit("first")
+delay 1100
+chain main_code
+copy "ucunit.sbu", "ucunit.tmp"
+
+' a changed source rebuilds the unit
+delay 1100
+write_unit("second version")
+chain main_code
+
+' a unit binary replaced behind the cache is read again
+kill "ucunit.sbu"
+copy "ucunit.tmp", "ucunit.sbu"
+chain main_code
+
+kill "ucunit.tmp"
+kill "ucunit.sbu"
+kill UNIT_FILE
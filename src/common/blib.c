@@ -21,27 +21,44 @@
  * CONST v[(x)] = any
  */
 void cmd_let(int is_const) {
-  var_t *v_left = code_getvarptr();
+  uint32_t idx = 0;
+  bcip_t ip = prog_ip;
+  var_t *array = code_getpacked();
+  var_t *v_left = array != NULL ? code_getvarptr_packed(array, &idx) : code_getvarptr();
   if (!prog_error) {
-    if (v_left->const_flag) {
+    if (v_left != NULL && v_left->const_flag) {
       err_const();
     } else {
       if (prog_source[prog_ip] == kwTYPE_CMPOPR &&
           prog_source[prog_ip + 1] == '=') {
         code_skipopr();
       }
+      // v_left must remain private to its array or map
+      int lock = (v_left != NULL && !code_is_plainvar(ip, v_left));
       var_t v_right;
       v_init(&v_right);
+      v_share_lock += lock;
       eval(&v_right);
-      v_move(v_left, &v_right);
-      v_left->const_flag = is_const;
-      // no free after v_move
+      v_share_lock -= lock;
+      if (v_left != NULL) {
+        v_move(v_left, &v_right);
+        v_left->const_flag = is_const;
+        // no free after v_move
+      } else if (array != NULL && array->type == V_ARRAY && idx < v_asize(array)) {
+        // element of a packed array
+        v_array_set(array, idx, &v_right);
+      } else {
+        v_free(&v_right);
+      }
     }
   }
 }
 
 void cmd_let_opt() {
-  var_t *v_left = code_getvarptr();
+  uint32_t idx = 0;
+  bcip_t ip = prog_ip;
+  var_t *array = code_getpacked();
+  var_t *v_left = array != NULL ? code_getvarptr_packed(array, &idx) : code_getvarptr();
   if (!prog_error) {
     // skip kwTYPE_CMPOPR + "="
     code_skipopr();
@@ -49,8 +66,138 @@ void cmd_let_opt() {
     // skip kwTYPE_VAR
     code_skipnext();
 
-    v_set(v_left, tvar[code_getaddr()]);
-    v_left->const_flag = 0;
+    var_t *v_right = tvar[code_getaddr()];
+    if (v_left == NULL && array->type == V_ARRAY && idx < v_asize(array)) {
+      if (v_right->type == V_INT || v_right->type == V_NUM) {
+        v_array_set(array, idx, v_right);
+      } else {
+        v_left = v_elem(array, idx);
+      }
+    }
+    if (v_left == NULL) {
+      // packed element assigned above
+    } else if ((v_right->type == V_ARRAY || v_right->type == V_MAP) && !code_is_plainvar(ip, v_left)) {
+      // v_left must remain private and may be held in v_right, eg: a(0) = a
+      var_t v_copy;
+      v_init(&v_copy);
+      v_share_lock++;
+      v_set(&v_copy, v_right);
+      v_share_lock--;
+      v_move(v_left, &v_copy);
+      v_left->const_flag = 0;
+    } else {
+      v_set(v_left, v_right);
+      v_left->const_flag = 0;
+    }
+  }
+}
+
+/**
+ * LET v = v +/- int
+ *
+ * superinstruction from comp_optimise(), falls back to cmd_let()
+ * when v is not a plain number
+ */
+void cmd_let_add_int() {
+  var_t *v = tvar[code_peekaddr(prog_ip + 1)];
+  if ((v->type != V_INT && v->type != V_NUM) || v->const_flag) {
+    cmd_let(0);
+  } else {
+    // skip [VAR][addr] [CMPOPR][=]
+    prog_ip += ADDRSZ + 3;
+    var_int_t k;
+    memcpy(&k, prog_source + prog_ip + BC_VAR_OPR_INT_K, OS_INTSZ);
+    byte op = prog_source[prog_ip + BC_VAR_OPR_INT_OPR + 1];
+    if (v->type == V_INT) {
+      v->v.i = (op == '+') ? v->v.i + k : v->v.i - k;
+    } else {
+      v->v.n = (op == '+') ? v->v.n + k : v->v.n - k;
+    }
+    prog_ip += BC_VAR_OPR_INT_LEN;
+  }
+}
+
+/**
+ * LET v = a(int)
+ *
+ * superinstruction from comp_optimise(), falls back to cmd_let()
+ * unless a is a one dimensional array holding a plain value at index int
+ */
+void cmd_let_elem_int() {
+  var_t *v = tvar[code_peekaddr(prog_ip + 1)];
+  var_t *array = tvar[code_peekaddr(prog_ip + ADDRSZ + 4)];
+  var_t *elem = NULL;
+  var_t tmp;
+  if ((v->type == V_INT || v->type == V_NUM || v->type == V_STR) &&
+      !v->const_flag && array->type == V_ARRAY && v_maxdim(array) == 1) {
+    var_int_t idx;
+    memcpy(&idx, prog_source + prog_ip + (ADDRSZ * 2) + 6, OS_INTSZ);
+    idx -= v_lbound(array, 0);
+    if (idx >= 0 && idx < v_asize(array)) {
+      elem = v_array_get(array, idx, &tmp);
+    }
+  }
+  if (elem == NULL || (elem->type != V_INT && elem->type != V_NUM && elem->type != V_STR)) {
+    cmd_let(0);
+  } else {
+    v_set(v, elem);
+    v->const_flag = 0;
+    prog_ip += (ADDRSZ * 2) + OS_INTSZ + 7;
+  }
+}
+
+/**
+ * LET s = s + a [+ b ...]
+ *
+ * superinstruction from comp_optimise(), appends to the string in place,
+ * falls back to cmd_let() when s is not a string
+ */
+void cmd_let_append() {
+  var_t *v = tvar[code_peekaddr(prog_ip + 1)];
+  if (v->type != V_STR || v->const_flag) {
+    cmd_let(0);
+    return;
+  }
+
+  // skip [VAR][addr] [CMPOPR][=] [VAR][addr]
+  prog_ip += (ADDRSZ * 2) + 4;
+
+  // evaluate every operand before s is modified
+  var_t args[BC_LET_APPEND_MAX];
+  int count = 0;
+  while (!prog_error && code_peek() == kwTYPE_EVPUSH) {
+    code_skipnext();
+    v_init(&args[count]);
+    eval_operand(&args[count++]);
+    // skip [EVPOP] [ADDOPR][+]
+    prog_ip += 3;
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (prog_error) {
+      // operand not used
+    } else if (v->type == V_ARRAY || args[i].type == V_ARRAY) {
+      err_matop();
+    } else {
+      v_append(v, &args[i]);
+    }
+    v_free(&args[i]);
+  }
+}
+
+/**
+ * PRINT v
+ *
+ * superinstruction from comp_optimise(), falls back to cmd_print()
+ */
+void cmd_print_var() {
+  var_t *v = tvar[code_peekaddr(prog_ip + 1)];
+  if (v->type != V_INT && v->type != V_NUM && v->type != V_STR) {
+    cmd_print(PV_CONSOLE);
+  } else {
+    pv_writevar(v, PV_CONSOLE, 0);
+    pv_write("\n", PV_CONSOLE, 0);
+    prog_ip += ADDRSZ + 1;
   }
 }
 
@@ -62,6 +209,7 @@ void cmd_packed_let() {
 
     int size = PKG_INIT_SIZE;
     int count = 0;
+    int lock = 0;
     var_t **vars = (var_t **)malloc(sizeof(var_t *) * size);
 
     while (code_peek() != kwTYPE_LEVEL_END && !prog_error) {
@@ -69,7 +217,11 @@ void cmd_packed_let() {
         size += PKG_INIT_SIZE;
         vars = (var_t **)realloc(vars, sizeof(var_t *) * size);
       }
-      vars[count++] = code_getvarptr();
+      bcip_t ip = prog_ip;
+      vars[count] = code_getvarptr();
+      if (!code_is_plainvar(ip, vars[count++])) {
+        lock = 1;
+      }
 
       // skip separator
       if (code_peek() == kwTYPE_SEP) {
@@ -85,6 +237,7 @@ void cmd_packed_let() {
     var_t v_right_eval;
     var_t *v_right;
     v_init(&v_right_eval);
+    v_share_lock += lock;
     if (code_isvar()) {
       // avoid memory allocation
       v_right = code_getvarptr();
@@ -101,7 +254,8 @@ void cmd_packed_let() {
           v_set(vars[0], v_right);
         } else {
           for (int i = 0; i < count; i++) {
-            v_set(vars[i], v_elem(v_right, i));
+            var_t tmp;
+            v_set(vars[i], v_array_get(v_right, i, &tmp));
           }
         }
       } else if (arrayCount > count) {
@@ -110,6 +264,7 @@ void cmd_packed_let() {
         rt_raise(ERR_PACK_TOO_FEW, arrayCount);
       }
     }
+    v_share_lock -= lock;
     v_free(&v_right_eval);
     free(vars);
   }
@@ -172,7 +327,7 @@ uint8_t get_dimensions(int32_t **lbound, int32_t **ubound) {
 }
 
 /**
- *  DIM var([lower TO] uppper [, ...])
+ *  DIM var([lower TO] uppper [, ...]) [AS INTEGER|REAL]
  */
 void cmd_dim(int preserve) {
   do {
@@ -196,12 +351,20 @@ void cmd_dim(int preserve) {
     int32_t *lbound = NULL;
     int32_t *ubound = NULL;
     uint8_t dimensions = get_dimensions(&lbound, &ubound);
+    uint8_t pack_type = V_PACK_NONE;
+    if (code_peek() == kwAS && prog_source[prog_ip + 1] == kwTYPE_SEP) {
+      // packed array of numbers
+      code_skipnext();
+      code_skipnext();
+      pack_type = code_getnext();
+    }
     if (!prog_error) {
       if (!preserve || var_p->type != V_ARRAY) {
         v_free(var_p);
       }
       if (!dimensions) {
         v_toarray1(var_p, 0);
+        var_p->pack_type = pack_type;
         continue;
       }
       uint32_t size = 1;
@@ -209,12 +372,19 @@ void cmd_dim(int preserve) {
         size = size * (ABS(ubound[i] - lbound[i]) + 1);
       }
       if (!preserve || var_p->type != V_ARRAY) {
-        v_new_array(var_p, size);
+        if (pack_type != V_PACK_NONE) {
+          v_new_packed_array(var_p, size, pack_type);
+        } else {
+          v_new_array(var_p, size);
+        }
       } else {
         // preserve previous array contents
+        if (pack_type != V_PACK_NONE) {
+          v_array_pack(var_p, pack_type);
+        }
         v_resize_array(var_p, size);
       }
-      v_maxdim(var_p) = dimensions;
+      v_set_maxdim(var_p, dimensions);
       for (int i = 0; i < dimensions; i++) {
         v_lbound(var_p, i) = lbound[i];
         v_ubound(var_p, i) = ubound[i];
@@ -238,10 +408,12 @@ void cmd_redim() {
  * A << x1 [, x2, ...]
  */
 void cmd_append() {
+  bcip_t ip = prog_ip;
   var_t *var_p = code_getvarptr();
   if (prog_error) {
     return;
   }
+  int lock = !code_is_plainvar(ip, var_p);
 
   if (code_peek() == kwTYPE_CMPOPR && prog_source[prog_ip + 1] == '=') {
     // compatible with LET, operator format
@@ -256,19 +428,25 @@ void cmd_append() {
 
   // for each argument to append
   do {
-    // find the array element
-    var_t *elem_p;
+    // evaluate before resizing, so a value sharing the array storage
+    // is left holding the previous copy
+    var_t arg;
+    v_init(&arg);
+    v_share_lock += lock;
+    eval(&arg);
+    v_share_lock -= lock;
+    if (prog_error) {
+      v_free(&arg);
+      break;
+    }
+
+    // set the value onto the new element
     if (var_p->type != V_ARRAY) {
       v_toarray1(var_p, 1);
-      elem_p = v_elem(var_p, 0);
     } else {
       v_resize_array(var_p, v_asize(var_p) + 1);
-      elem_p = v_elem(var_p, v_asize(var_p) - 1);
     }
-
-    // set the value onto the element
-    v_init(elem_p);
-    eval(elem_p);
+    v_array_set(var_p, v_asize(var_p) - 1, &arg);
 
     // next parameter
     if (code_peek() != kwTYPE_SEP) {
@@ -286,10 +464,12 @@ void cmd_append() {
  * INSERT A, index, v1 [, vN]
  */
 void cmd_lins() {
+  bcip_t ip = prog_ip;
   var_t *var_p = code_getvarptr();
   if (prog_error) {
     return;
   }
+  int lock = !code_is_plainvar(ip, var_p);
   par_getcomma();
   if (prog_error) {
     return;
@@ -323,18 +503,32 @@ void cmd_lins() {
   }
 
   // for each argument to insert
-  var_t *arg_p = v_new();
+  var_t arg;
+  var_t *arg_p = &arg;
+  v_init(arg_p);
   do {
     // get the value to append
     v_free(arg_p);
+    v_share_lock += lock;
     eval(arg_p);
+    v_share_lock -= lock;
 
     // resize +1
     v_resize_array(var_p, v_asize(var_p) + 1);
 
     // find the array element
     var_t *elem_p;
-    if (ladd) {
+    if (v_is_packed(var_p)) {
+      if (!ladd) {
+        memmove(v_idata(var_p) + idx + 1, v_idata(var_p) + idx,
+                (v_asize(var_p) - idx - 1) * OS_INTSZ);
+      }
+      var_t value;
+      v_init(&value);
+      v_set(&value, arg_p);
+      v_array_set(var_p, ladd ? v_asize(var_p) - 1 : idx, &value);
+      elem_p = NULL;
+    } else if (ladd) {
       // append
       elem_p = v_elem(var_p, v_asize(var_p) - 1);
     } else {
@@ -347,7 +541,9 @@ void cmd_lins() {
     }
 
     // set the value onto the element
-    v_set(elem_p, arg_p);
+    if (elem_p != NULL) {
+      v_set(elem_p, arg_p);
+    }
 
     // next parameter
     if (code_peek() != kwTYPE_SEP) {
@@ -362,7 +558,6 @@ void cmd_lins() {
 
   // cleanup
   v_free(arg_p);
-  v_detach(arg_p);
 }
 
 /**
@@ -419,6 +614,11 @@ void cmd_ldel() {
   if (idx + count == size) {
     // pop elements from a stack
     v_resize_array(var_p, size - count);
+  } else if (v_is_packed(var_p)) {
+    v_array_unshare(var_p);
+    memmove(v_idata(var_p) + idx, v_idata(var_p) + idx + count,
+            (size - idx - count) * OS_INTSZ);
+    v_resize_array(var_p, size - count);
   } else if (idx == 0) {
     // pop element from a queue
     // for better performance create a queue in the language
@@ -427,23 +627,24 @@ void cmd_ldel() {
     }
     v_resize_array(var_p, size - count);
   } else {
-    var_t *arg_p = v_clone(var_p);
+    var_t arg;
+    v_init(&arg);
+    v_set(&arg, var_p);
     v_resize_array(var_p, size - count);
 
     // first part
     for (int i = 0; i < idx; i++) {
       // A(i) = OLD(i)
-      v_set(v_elem(var_p, i), v_elem(arg_p, i));
+      v_set(v_elem(var_p, i), v_elem(&arg, i));
     }
     // second part
     for (int i = idx + count, j = idx; i < size; i++, j++) {
       // A(j) = OLD(i)
-      v_set(v_elem(var_p, j), v_elem(arg_p, i));
+      v_set(v_elem(var_p, j), v_elem(&arg, i));
     }
 
     // cleanup
-    v_free(arg_p);
-    v_detach(arg_p);
+    v_free(&arg);
   }
 }
 
@@ -555,7 +756,7 @@ void cmd_print(int output) {
         v_free(&var);
         return;
       } else {
-        build_format(var.v.p.ptr);
+        build_format(v_strptr(&var));
         v_free(&var);
       }
     }
@@ -592,7 +793,7 @@ void cmd_print(int output) {
         if (use_format) {
           switch (var.type) {
           case V_STR:
-            fmt_printS(var.v.p.ptr, output, handle);
+            fmt_printS(v_strptr(&var), output, handle);
             break;
           case V_INT:
             fmt_printN(var.v.i, output, handle);
@@ -712,8 +913,8 @@ void cmd_input(int input) {
     do {
       // "redo from start"
       if (input == PV_CONSOLE) {  // prompt
-        if (prompt.v.p.ptr) {
-          pv_write(prompt.v.p.ptr, input, handle);
+        if (v_strptr(&prompt)) {
+          pv_write(v_strptr(&prompt), input, handle);
         }
       }
 
@@ -722,18 +923,18 @@ void cmd_input(int input) {
       case PV_CONSOLE:
         // console
         inps = malloc(SB_TEXTLINE_SIZE + 1);
-        if (prompt.v.p.ptr) {
+        if (v_strptr(&prompt)) {
           // prime output buffer with prompt text
           int prompt_len = v_strlen(&prompt);
           int len = prompt_len < SB_TEXTLINE_SIZE ? prompt_len : SB_TEXTLINE_SIZE;
-          strncpy(inps, prompt.v.p.ptr, len);
+          strncpy(inps, v_strptr(&prompt), len);
           inps[len] = 0;
         }
         dev_gets(inps, SB_TEXTLINE_SIZE);
         break;
       case PV_STRING:
         // string (SINPUT)
-        inps = strdup(vuser_p->v.p.ptr);
+        inps = strdup(v_strptr(vuser_p));
         break;
       case PV_FILE:
         // file (INPUT#)
@@ -822,7 +1023,7 @@ void cmd_input(int input) {
               *p = lc;
 
               // next pos
-              inp_p = p + ((next_is_const) ? strlen(ptable[cur_par_idx].var->v.p.ptr) : 1);
+              inp_p = p + ((next_is_const) ? strlen(v_strptr(ptable[cur_par_idx].var)) : 1);
               if (*p == '\0') {
                 input_is_finished = 1;
               }
@@ -945,6 +1146,8 @@ void cmd_gosub() {
  * p1...pN nodes will be removed by cmd_param()
  * cmd_param is the first UDP/F's command
  *
+ * by value arguments are evaluated into the callee's frame
+ *
  * @param cmd is the type of the udp (function or procedure)
  * @param target sub/func
  * @param return-variable ID
@@ -952,7 +1155,7 @@ void cmd_gosub() {
 bcip_t cmd_push_args(int cmd, bcip_t goto_addr, bcip_t rvid) {
   bcip_t ofs;
   bcip_t pcount = 0;
-  var_t *arg = NULL;
+  uint32_t frame = prog_frame_count;
 
   if (code_peek() == kwTYPE_LEVEL_BEGIN) {
     // kwTYPE_LEVEL_BEGIN (which means left-parenthesis)
@@ -996,6 +1199,9 @@ bcip_t cmd_push_args(int cmd, bcip_t goto_addr, bcip_t rvid) {
           stknode_t *param = code_push(kwTYPE_VAR); // push parameter
           param->x.param.res = code_getvarptr(); // var_t pointer; the variable itself
           param->x.param.vcheck = 0x3; // parameter can be used 'by value' or 'by reference'
+          if (!code_is_plainvar(ofs, param->x.param.res)) {
+            param->x.param.vcheck |= 0x4; // an element or field, see v_share_lock
+          }
           pcount++;
           break;             // we finished with this parameter
         }
@@ -1004,10 +1210,10 @@ bcip_t cmd_push_args(int cmd, bcip_t goto_addr, bcip_t rvid) {
         // now we are sure, this parameter is not a single variable
         // no 'break' here
 
-      default:
+      default: {
         // default: the parameter is an expression
-        arg = v_new();       // create a new temporary variable; it is the
-                             // by-val value 'arg' will be freed at udp's return
+        // the by-val value is released with the frame at udp's return
+        var_t *arg = &frame_push()->var;
         eval(arg);           // execute the expression and store the result to 'arg'
 
         if (!prog_error) {
@@ -1016,11 +1222,11 @@ bcip_t cmd_push_args(int cmd, bcip_t goto_addr, bcip_t rvid) {
           param->x.param.vcheck = 1; // parameter can be used only as 'by value'
           pcount++;
         } else {             // error; clean up and return
-          v_free(arg);
-          v_detach(arg);
+          frame_release(frame);
           return 0;
         }
       }
+      }
     } while (!ready);
   }
 
@@ -1029,6 +1235,7 @@ bcip_t cmd_push_args(int cmd, bcip_t goto_addr, bcip_t rvid) {
   vcall->x.vcall.pcount = pcount;    // number parameter-nodes in the stack
   vcall->x.vcall.ret_ip = prog_ip;   // where to go after exit (caller's next address)
   vcall->x.vcall.rvid = rvid;        // return-variable ID
+  vcall->x.vcall.frame = frame;      // first local variable
   vcall->x.vcall.task_id = -1;
 
   if (rvid != INVALID_ADDR) {
@@ -1060,6 +1267,10 @@ void cmd_call_unit_udp(int cmd, int udp_tid, bcip_t goto_addr, bcip_t rvid) {
   bcip_t pcount = 0;
   int my_tid = ctask->tid;
 
+  activate_task(udp_tid);
+  uint32_t frame = prog_frame_count;
+  activate_task(my_tid);
+
   if (code_peek() == kwTYPE_LEVEL_BEGIN) {
     code_skipnext();         // kwTYPE_LEVEL_BEGIN (which means left-parenthesis)
 
@@ -1085,10 +1296,14 @@ void cmd_call_unit_udp(int cmd, int udp_tid, bcip_t goto_addr, bcip_t rvid) {
 
         if (code_isvar()) {  // this parameter is a single variable (not an expression)
           var_p_t var = code_getvarptr(); // var_t pointer; the variable itself
+          int is_plain = code_is_plainvar(ofs, var);
           activate_task(udp_tid);
           stknode_t *param = code_push(kwTYPE_VAR); // push parameter, on unit's task
           param->x.param.res = var;
           param->x.param.vcheck = 0x3; // parameter can be used 'by value' or 'by reference'
+          if (!is_plain) {
+            param->x.param.vcheck |= 0x4; // an element or field, see v_share_lock
+          }
           activate_task(my_tid);
           pcount++;
           break;             // we finished with this parameter
@@ -1099,9 +1314,11 @@ void cmd_call_unit_udp(int cmd, int udp_tid, bcip_t goto_addr, bcip_t rvid) {
         // no 'break' here
 
       default:
-        // default: the parameter is an expression
-        arg = v_new();       // create a new temporary variable; it is the by-val value
-                             // 'arg' will be freed at udp's return
+        // default: the parameter is an expression, the by-val value is
+        // created in the unit's frame and released at udp's return
+        activate_task(udp_tid);
+        arg = &frame_push()->var;
+        activate_task(my_tid);
         eval(arg);           // execute the expression and store the result to 'arg'
 
         if (!prog_error) {
@@ -1113,8 +1330,9 @@ void cmd_call_unit_udp(int cmd, int udp_tid, bcip_t goto_addr, bcip_t rvid) {
           activate_task(my_tid);
           pcount++;
         } else {             // error; clean up and return
-          v_free(arg);
-          v_detach(arg);
+          activate_task(udp_tid);
+          frame_release(frame);
+          activate_task(my_tid);
           return;
         }
       }
@@ -1135,6 +1353,7 @@ void cmd_call_unit_udp(int cmd, int udp_tid, bcip_t goto_addr, bcip_t rvid) {
   vcall->x.vcall.pcount = pcount;   // the number of parameter-nodes in the stack
   vcall->x.vcall.ret_ip = prog_ip;   // where to go after exit (caller's next address)
   vcall->x.vcall.rvid = rvid;        // return-variable ID
+  vcall->x.vcall.frame = frame;      // first local variable
   vcall->x.vcall.task_id = my_tid;
 
   if (rvid != INVALID_ADDR) {            // if we call a function
@@ -1148,22 +1367,49 @@ void cmd_call_unit_udp(int cmd, int udp_tid, bcip_t goto_addr, bcip_t rvid) {
 
 /**
  * Create dynamic-variables (actually local-variables)
+ *
+ * locals declared in the body of the SUB/FUNC are added to the call's
+ * frame. locals declared inside a block (loop, IF, etc) go out of scope
+ * with the block, these are pushed on the stack as kwTYPE_CRVAR nodes
  */
 void cmd_crvar() {
+  stknode_t *top = code_stackpeek();
+  int in_frame = (top == NULL || top->type == kwPROC || top->type == kwFUNC);
+  uint32_t base = (in_frame && top != NULL) ? top->x.vcall.frame : 0;
+
   // number of variables to create
   int count = code_getnext();
   for (int i = 0; i < count; i++) {
     // an ID on global-variable-table is used
     bcip_t vid = code_getaddr();
 
-    // store previous variable to stack
-    // we will restore it at 'return'
-    stknode_t *node = code_push(kwTYPE_CRVAR);
-    node->x.vdvar.vid = vid;
-    node->x.vdvar.vptr = tvar[vid];
+    if (in_frame) {
+      // reuse the frame variable when declared again, eg: GOTO before LOCAL
+      frame_var_t *fv = NULL;
+      for (uint32_t f = prog_frame_count; f > base; f--) {
+        frame_var_t *next = frame_at(f - 1);
+        if (next->vid == (bid_t)vid && tvar[vid] == &next->var) {
+          fv = next;
+          break;
+        }
+      }
+      if (fv != NULL) {
+        v_free(&fv->var);
+        v_init(&fv->var);
+      } else {
+        fv = frame_push();
+        frame_bind(fv, vid, &fv->var);
+      }
+    } else {
+      // store previous variable to stack
+      // we will restore it at the end of the block
+      stknode_t *node = code_push(kwTYPE_CRVAR);
+      node->x.vdvar.vid = vid;
+      node->x.vdvar.vptr = tvar[vid];
 
-    // create a new variable with the same ID
-    tvar[vid] = v_new();
+      // create a new variable with the same ID
+      tvar[vid] = v_new();
+    }
   }
 }
 
@@ -1173,8 +1419,8 @@ void cmd_crvar() {
  * this code will be called by udp/f to check parameter nodes
  * stored in stack by the cmd_udp (call to udp/f)
  *
- * 'by value' parameters are stored as local variables in the stack (kwTYPE_CRVAR)
- * 'by reference' parameters are stored as local variables in the stack (kwTYPE_BYREF)
+ * the parameters are moved into the call's frame and their stack nodes
+ * are removed, leaving the caller's info-node at the top of the stack
  */
 void cmd_param() {
   // get caller's info-node
@@ -1209,16 +1455,14 @@ void cmd_param() {
       }
       else if ((vattr & 0x80) == 0) {
         // UDP requires a 'by value' parameter
-        node->type = kwTYPE_CRVAR;
-        node->x.vdvar.vid = vid;
-        node->x.vdvar.vptr = tvar[vid];
-
-        // assign
         if (vcheck == 1) {
-          // its already cloned by the CALL (expr)
-          tvar[vid] = param_var;
+          // its already evaluated into the frame by the CALL (expr)
+          frame_var_t *fv = (frame_var_t *)param_var;
+          frame_bind(fv, vid, &fv->var);
         } else {
-          tvar[vid] = v_clone(param_var);
+          frame_var_t *fv = frame_push();
+          v_set(&fv->var, param_var);
+          frame_bind(fv, vid, &fv->var);
         }
       } else if (vcheck == 1) {
         // error - the parameter can be used only 'by value'
@@ -1226,12 +1470,23 @@ void cmd_param() {
         break;
       } else {
         // UDP requires 'by reference' parameter
-        node->type = kwBYREF;
-        node->x.vdvar.vid = vid;
-        node->x.vdvar.vptr = tvar[vid];
-        tvar[vid] = param_var;
+        frame_var_t *fv = frame_push();
+        frame_bind(fv, vid, param_var);
+        if (vcheck & 0x4) {
+          // the storage holding param_var must not be shared until return
+          fv->share_lock = 1;
+          v_share_lock++;
+        }
       }
     }
+
+    if (!prog_error) {
+      // remove the parameter nodes
+      int call_pos = prog_stack_count - 1 - pcount;
+      prog_stack[call_pos] = prog_stack[prog_stack_count - 1];
+      prog_stack[call_pos].x.vcall.pcount = 0;
+      prog_stack_count = call_pos + 1;
+    }
   }
 }
 
@@ -1257,24 +1512,8 @@ void cmd_udpret() {
     return;
   }
 
-  // handle parameters
-  int i;
-  for (i = ncall.x.vcall.pcount; i > 0 && !prog_error; i--) {
-    stknode_t node;
-    code_pop(&node, 0);
-
-    // local variable - cleanup
-    if (node.type == kwTYPE_CRVAR) {
-      // free local variable data
-      v_free(tvar[node.x.vdvar.vid]);
-      v_detach(tvar[node.x.vdvar.vid]);
-      // restore ptr (replace to pre-call variable)
-      tvar[node.x.vdvar.vid] = node.x.vdvar.vptr;
-    } else if (node.type == kwBYREF) {
-      // variable 'by reference', restore ptr
-      tvar[node.x.vdvar.vid] = node.x.vdvar.vptr;
-    }
-  }
+  // release parameters and locals, cmd_param() removed the parameter nodes
+  frame_release(ncall.x.vcall.frame);
 
   // restore return value
   if (ncall.x.vcall.rvid != (bid_t) INVALID_ADDR) {
@@ -1289,6 +1528,116 @@ void cmd_udpret() {
   prog_ip = ncall.x.vcall.ret_ip;
 }
 
+/**
+ * whether the parameters of the UDP/F at goto_addr are all 'by value'
+ */
+int cmd_tail_call_byval(bcip_t goto_addr) {
+  int result = 1;
+  if (prog_source[goto_addr] == kwTYPE_PARAM) {
+    int pcount = prog_source[goto_addr + 1];
+    for (int i = 0; i < pcount && result; i++) {
+      byte vattr = prog_source[goto_addr + 2 + i * (ADDRSZ + 1)];
+      result = ((vattr & 0x80) == 0);
+    }
+  }
+  return result;
+}
+
+/**
+ * LET rv = f(...) followed by the FUNC's RETURN
+ *
+ * superinstruction from comp_optimise(). when rv is the return variable of
+ * the current FUNC, the current call is replaced with the call to f so that
+ * tail recursive functions run in constant stack. otherwise falls back to cmd_let()
+ */
+void cmd_tail_call() {
+  bid_t vid = code_peekaddr(prog_ip + 1);
+  bcip_t call_ip = prog_ip + ADDRSZ + 3;
+  bcip_t goto_addr = code_peekaddr(call_ip + 1);
+  bid_t rvid = code_peekaddr(call_ip + 1 + ADDRSZ);
+
+  // find the current call, the nodes above are blocks within the FUNC
+  int call_pos = prog_stack_count - 1;
+  while (call_pos >= 0 &&
+         prog_stack[call_pos].type != kwFUNC &&
+         prog_stack[call_pos].type != kwPROC &&
+         prog_stack[call_pos].type != kwTRY &&
+         prog_stack[call_pos].type != kwCATCH) {
+    call_pos--;
+  }
+  if (call_pos < 0 ||
+      prog_stack[call_pos].type != kwFUNC ||
+      prog_stack[call_pos].x.vcall.rvid != vid ||
+      !cmd_tail_call_byval(goto_addr)) {
+    // not a tail call, or TRY must stay in scope, or BYREF parameters might
+    // refer to the locals of this call
+    cmd_let(0);
+    return;
+  }
+
+  // push the arguments and the call to f
+  uint32_t frame = prog_frame_count;
+  prog_ip = call_ip + 1 + (ADDRSZ * 2);
+  goto_addr = cmd_push_args(kwFUNC, goto_addr, rvid);
+  if (prog_error) {
+    return;
+  }
+  stknode_t fcall = prog_stack[--prog_stack_count];
+  int pcount = fcall.x.vcall.pcount;
+  int param_pos = prog_stack_count - pcount;
+
+  // variable arguments are passed by value, copy before the locals are released
+  for (int i = param_pos; i < param_pos + pcount; i++) {
+    stknode_t *param = &prog_stack[i];
+    if (param->x.param.vcheck != 1) {
+      frame_var_t *fv = frame_push();
+      v_set(&fv->var, param->x.param.res);
+      param->x.param.res = &fv->var;
+      param->x.param.vcheck = 1;
+    }
+  }
+
+  // release the result variable of this call
+  stknode_t ncall = prog_stack[call_pos];
+  if (fcall.x.vcall.rvid == ncall.x.vcall.rvid) {
+    // recursive call, fcall.retvar is the result variable of this call
+    v_free(fcall.x.vcall.retvar);
+    v_detach(fcall.x.vcall.retvar);
+    fcall.x.vcall.retvar = ncall.x.vcall.retvar;
+  } else {
+    v_free(tvar[ncall.x.vcall.rvid]);
+    v_detach(tvar[ncall.x.vcall.rvid]);
+    tvar[ncall.x.vcall.rvid] = ncall.x.vcall.retvar;
+  }
+
+  // release any blocks within this call
+  for (int i = param_pos - 1; i > call_pos; i--) {
+    free_node(&prog_stack[i]);
+  }
+
+  // release the locals of this call, moving the arguments into their place
+  uint32_t base = ncall.x.vcall.frame;
+  for (int i = param_pos; i < param_pos + pcount; i++) {
+    for (uint32_t f = frame; f < prog_frame_count; f++) {
+      if (prog_stack[i].x.param.res == &frame_at(f)->var) {
+        prog_stack[i].x.param.res = &frame_at(base + (f - frame))->var;
+        break;
+      }
+    }
+  }
+  frame_drop(base, frame);
+
+  // replace this call with the call to f
+  memmove(&prog_stack[call_pos], &prog_stack[param_pos], sizeof(stknode_t) * pcount);
+  prog_stack_count = call_pos + pcount;
+  fcall.x.vcall.ret_ip = ncall.x.vcall.ret_ip;
+  fcall.x.vcall.frame = base;
+  fcall.x.vcall.task_id = ncall.x.vcall.task_id;
+  fcall.line = ncall.line;
+  prog_stack[prog_stack_count++] = fcall;
+  prog_ip = goto_addr;
+}
+
 /**
  * EXIT [FOR|LOOP|FUNC|PROC]
  */
@@ -1559,10 +1908,11 @@ void cmd_for_in(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
   }
 
   if (!prog_error) {
-    // element-index
+    // element-index, for a map the position of the key in insertion order
     node.x.vfor.step_expr_ip = 0;
 
     var_p_t var_elem_ptr = 0;
+    var_t elem_tmp;
     switch (array_p->type) {
     case V_MAP:
       var_elem_ptr = map_elem_key(array_p, 0);
@@ -1570,15 +1920,15 @@ void cmd_for_in(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
 
     case V_ARRAY:
       if (v_asize(array_p) > 0) {
-        var_elem_ptr = v_elem(array_p, 0);
+        var_elem_ptr = v_array_get(array_p, 0, &elem_tmp);
       }
       break;
 
     case V_STR:
       var_elem_ptr = node.x.vfor.str_ptr = v_new();
       v_init_str(var_elem_ptr, 1);
-      var_elem_ptr->v.p.ptr[0] = array_p->v.p.ptr[0];
-      var_elem_ptr->v.p.ptr[1] = '\0';
+      v_strptr(var_elem_ptr)[0] = v_strptr(array_p)[0];
+      v_strptr(var_elem_ptr)[1] = '\0';
       break;
 
     default:
@@ -1600,6 +1950,37 @@ void cmd_for_in(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
 //
 // FOR v1=exp1 TO exp2 [STEP exp3]
 //
+/*
+ * checks whether the expression just evaluated from expr_ip is a single
+ * constant or variable and stores it for the counted loop in NEXT
+ */
+code_t cmd_for_operand(bcip_t expr_ip, var_t *value, var_int_t *i, var_num_t *n, bid_t *id) {
+  code_t result = 0;
+  switch (prog_source[expr_ip]) {
+  case kwTYPE_INT:
+    if (prog_ip == expr_ip + 1 + OS_INTSZ && value->type == V_INT) {
+      *i = value->v.i;
+      result = kwTYPE_INT;
+    }
+    break;
+  case kwTYPE_NUM:
+    if (prog_ip == expr_ip + 1 + OS_REALSZ && value->type == V_NUM) {
+      *n = value->v.n;
+      result = kwTYPE_NUM;
+    }
+    break;
+  case kwTYPE_VAR:
+    if (prog_ip == expr_ip + 1 + ADDRSZ) {
+      *id = code_peekaddr(expr_ip + 1);
+      result = kwTYPE_VAR;
+    }
+    break;
+  default:
+    break;
+  }
+  return result;
+}
+
 void cmd_for_to(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
   var_t varstep;
   var_t var;
@@ -1629,6 +2010,8 @@ void cmd_for_to(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
       node.x.vfor.to_expr_ip = prog_ip;
       v_init(&var);
       eval(&var);
+      node.x.vfor.to_code = cmd_for_operand(node.x.vfor.to_expr_ip, &var, &node.x.vfor.to.i,
+                                            &node.x.vfor.to.n, &node.x.vfor.to.id);
 
       if (!prog_error && (var.type == V_NUM || var.type == V_INT)) {
         //
@@ -1639,6 +2022,9 @@ void cmd_for_to(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
           code_skipnext();
           node.x.vfor.step_expr_ip = prog_ip;
           eval(&varstep);
+          node.x.vfor.step_code = cmd_for_operand(node.x.vfor.step_expr_ip, &varstep,
+                                                  &node.x.vfor.step.i, &node.x.vfor.step.n,
+                                                  &node.x.vfor.step.id);
           if (!(varstep.type == V_NUM || varstep.type == V_INT)) {
             if (!prog_error) {
               err_syntax(kwFOR, "%N");
@@ -1646,9 +2032,14 @@ void cmd_for_to(bcip_t true_ip, bcip_t false_ip, var_p_t var_p) {
           }
         } else {
           node.x.vfor.step_expr_ip = INVALID_ADDR;
+          node.x.vfor.step_code = kwTYPE_INT;
+          node.x.vfor.step.i = 1;
           varstep.type = V_INT;
           varstep.v.i = 1;
         }
+        if (!node.x.vfor.step_code) {
+          node.x.vfor.to_code = 0;
+        }
       } else {
         if (!prog_error) {
           rt_raise(ERR_SYNTAX);
@@ -1782,7 +2173,7 @@ var_t *cmd_next_for_in_str(stknode_t *node) {
   int index = ++node->x.vfor.step_expr_ip;
   if (index < v_strlen(array_p)) {
     result = node->x.vfor.str_ptr;
-    result->v.p.ptr[0] = array_p->v.p.ptr[index];
+    v_strptr(result)[0] = v_strptr(array_p)[index];
   }
   return result;
 }
@@ -1793,6 +2184,7 @@ var_t *cmd_next_for_in_str(stknode_t *node) {
 void cmd_next_for_in(stknode_t *node, bcip_t next_ip) {
   var_t *array_p = node->x.vfor.arr_ptr;
   var_t *var_elem_ptr = NULL;
+  var_t elem_tmp;
 
   bcip_t jump_ip = node->x.vfor.jump_ip;
   var_t *var_p = node->x.vfor.var_ptr;
@@ -1808,7 +2200,7 @@ void cmd_next_for_in(stknode_t *node, bcip_t next_ip) {
 
   case V_ARRAY:
     if (v_asize(array_p) > (int) ++node->x.vfor.step_expr_ip) {
-      var_elem_ptr = v_elem(array_p, node->x.vfor.step_expr_ip);
+      var_elem_ptr = v_array_get(array_p, node->x.vfor.step_expr_ip, &elem_tmp);
     }
     break;
 
@@ -1837,6 +2229,79 @@ void cmd_next_for_in(stknode_t *node, bcip_t next_ip) {
   }
 }
 
+//
+// returns the TO or STEP value of a counted loop, NULL when it's not a number
+//
+static inline var_t *cmd_next_operand(code_t code, var_int_t i, var_num_t n, bid_t id, var_t *tmp) {
+  var_t *result;
+  switch (code) {
+  case kwTYPE_INT:
+    tmp->type = V_INT;
+    tmp->v.i = i;
+    result = tmp;
+    break;
+  case kwTYPE_NUM:
+    tmp->type = V_NUM;
+    tmp->v.n = n;
+    result = tmp;
+    break;
+  default:
+    result = tvar[id];
+    if (result->type != V_INT && result->type != V_NUM) {
+      result = NULL;
+    }
+    break;
+  }
+  return result;
+}
+
+//
+// FOR v=exp1 TO exp2 [STEP exp3] where TO and STEP are constants or variables,
+// the node is updated in place. returns 0 when the generic version is required
+//
+int cmd_next_counted(stknode_t *node, bcip_t next_ip) {
+  var_t *var_p = node->x.vfor.var_ptr;
+  var_t to_val, step_val;
+  int check;
+
+  if (var_p->type != V_INT && var_p->type != V_NUM) {
+    return 0;
+  }
+  var_t *to = cmd_next_operand(node->x.vfor.to_code, node->x.vfor.to.i, node->x.vfor.to.n,
+                               node->x.vfor.to.id, &to_val);
+  var_t *step = cmd_next_operand(node->x.vfor.step_code, node->x.vfor.step.i, node->x.vfor.step.n,
+                                 node->x.vfor.step.id, &step_val);
+  if (to == NULL || step == NULL) {
+    return 0;
+  }
+
+  if (var_p->type == V_INT && step->type == V_INT) {
+    var_p->v.i += step->v.i;
+    if (to->type == V_INT) {
+      check = step->v.i < 0 ? var_p->v.i >= to->v.i : var_p->v.i <= to->v.i;
+    } else {
+      // same as v_compare()
+      var_num_t diff = var_p->v.i - to->v.n;
+      check = (fabs(diff) < EPSILON) || (step->v.i < 0 ? diff > 0 : diff < 0);
+    }
+  } else {
+    v_inc(var_p, step);
+    if (v_sign(step) < 0) {
+      check = (v_compare(var_p, to) >= 0);
+    } else {
+      check = (v_compare(var_p, to) <= 0);
+    }
+  }
+
+  if (check) {
+    code_jump(node->x.vfor.jump_ip);
+  } else {
+    code_pop(NULL, 0);
+    code_jump(next_ip);
+  }
+  return 1;
+}
+
 //
 // FOR v=exp1 TO exp2 [STEP exp3]
 //
@@ -1904,6 +2369,12 @@ void cmd_next() {
   bcip_t next_ip = code_getaddr();
   code_skipaddr();
 
+  stknode_t *top = code_stackpeek();
+  if (top != NULL && top->type == kwFOR && top->x.vfor.subtype == kwTO &&
+      top->x.vfor.to_code && cmd_next_counted(top, next_ip)) {
+    return;
+  }
+
   stknode_t node;
   code_pop(&node, kwFOR);
 
@@ -1990,8 +2461,8 @@ void cmd_read() {
 
           vp->v.p.ptr = malloc(len + 1);
           vp->v.p.owner = 1;
-          memcpy(vp->v.p.ptr, prog_source + prog_dp, len);
-          *((vp->v.p.ptr + len)) = '\0';
+          memcpy(v_strptr(vp), prog_source + prog_dp, len);
+          *((v_strptr(vp) + len)) = '\0';
           vp->v.p.length = len;
           prog_dp += len;
         }
@@ -2051,6 +2522,7 @@ void cmd_delay() {
     return;
   }
   dev_delay(ms);
+  brun_poll_events();
 }
 
 /**
@@ -2316,10 +2788,11 @@ void cmd_wjoin() {
   str->type = V_STR;
   str->v.p.ptr = malloc(size);
   str->v.p.owner = 1;
-  str->v.p.ptr[0] = '\0';
+  v_strptr(str)[0] = '\0';
 
   for (i = 0; i < v_asize(var_p); i++) {
-    var_t *elem_p = v_elem(var_p, i);
+    var_t tmp;
+    var_t *elem_p = v_array_get(var_p, i, &tmp);
     var_t e_str;
 
     v_init(&e_str);
@@ -2335,11 +2808,11 @@ void cmd_wjoin() {
     }
 
     len += el_len;
-    strcat(str->v.p.ptr, e_str.v.p.ptr);
+    strcat(v_strptr(str), v_strptr(&e_str));
     v_free(&e_str);
 
-    if (i != var_p->v.p.length - 1) {
-      strcat(str->v.p.ptr, del.v.p.ptr);
+    if (i != v_asize(var_p) - 1) {
+      strcat(v_strptr(str), v_strptr(&del));
       len += del_len;
     }
   }
@@ -2360,12 +2833,12 @@ void cmd_environ() {
   if (prog_error) {
     return;
   }
-  char *eq = strchr(str.v.p.ptr, '=');
+  char *eq = strchr(v_strptr(&str), '=');
   if (eq == NULL) {
     rt_raise(ERR_PUTENV);
   } else {
     *eq = '\0';
-    if (dev_setenv(str.v.p.ptr, eq + 1) == -1) {
+    if (dev_setenv(v_strptr(&str), eq + 1) == -1) {
       rt_raise(ERR_PUTENV);
     }
   }
@@ -2383,7 +2856,7 @@ void cmd_datedmy() {
   eval(&arg);
 
   if (arg.type == V_STR) {
-    date_str2dmy(arg.v.p.ptr, &d, &m, &y);
+    date_str2dmy(v_strptr(&arg), &d, &m, &y);
     v_free(&arg);
   } else {
     // julian
@@ -2441,7 +2914,7 @@ void cmd_timehms() {
 
   if (arg.type == V_STR) {
     // string
-    date_str2hms(arg.v.p.ptr, &h, &m, &s);
+    date_str2hms(v_strptr(&arg), &h, &m, &s);
     v_free(&arg);
   } else {
     // timer
@@ -2518,6 +2991,18 @@ int qs_cmp(const void *a, const void *b) {
   return sb_qcmp(ea, eb, static_qsort_last_use_ip);
 }
 
+int qs_cmp_int(const void *a, const void *b) {
+  var_int_t ia = *(const var_int_t *)a;
+  var_int_t ib = *(const var_int_t *)b;
+  return ia < ib ? -1 : ia > ib ? 1 : 0;
+}
+
+int qs_cmp_num(const void *a, const void *b) {
+  var_num_t na = *(const var_num_t *)a;
+  var_num_t nb = *(const var_num_t *)b;
+  return na < nb ? -1 : na > nb ? 1 : 0;
+}
+
 void cmd_sort() {
   bcip_t use_ip, exit_ip;
   var_t *var_p;
@@ -2545,7 +3030,26 @@ void cmd_sort() {
   if (!errf) {
     if (v_asize(var_p) > 1) {
       static_qsort_last_use_ip = use_ip;
-      qsort(v_data(var_p), v_asize(var_p), sizeof(var_t), qs_cmp);
+      if (use_ip != INVALID_ADDR && v_is_packed(var_p)) {
+        // the USE expression works with var_t elements
+        v_array_unpack(var_p);
+      }
+      v_array_unshare(var_p);
+
+      // the USE expression must not share the elements being sorted
+      v_share_lock += (use_ip != INVALID_ADDR);
+      switch (var_p->pack_type) {
+      case V_PACK_INT:
+        qsort(v_data(var_p), v_asize(var_p), OS_INTSZ, qs_cmp_int);
+        break;
+      case V_PACK_NUM:
+        qsort(v_data(var_p), v_asize(var_p), OS_REALSZ, qs_cmp_num);
+        break;
+      default:
+        qsort(v_data(var_p), v_asize(var_p), sizeof(var_t), qs_cmp);
+        break;
+      }
+      v_share_lock -= (use_ip != INVALID_ADDR);
     }
   }
   // NO RTE anymore... there is no meaning on this because of empty
@@ -2612,7 +3116,8 @@ void cmd_search() {
   if (!errf) {
     rv_p->v.i = v_lbound(var_p, 0) - 1;
     for (int i = 0; i < v_asize(var_p); i++) {
-      var_t *elem_p = v_elem(var_p, i);
+      var_t tmp;
+      var_t *elem_p = v_array_get(var_p, i, &tmp);
       int bcmp = sb_qcmp(elem_p, &vkey, use_ip);
       if (bcmp == 0) {
         rv_p->v.i = i + v_lbound(var_p, 0);
@@ -2638,7 +3143,7 @@ void cmd_search() {
  * SWAP a, b
  */
 void cmd_swap(void) {
-  var_t *va, *vb, *vc;
+  var_t *va, *vb, vc;
 
   if (code_isvar()) {
     va = code_getvarptr();
@@ -2657,12 +3162,13 @@ void cmd_swap(void) {
     return;
   }
 
-  vc = v_new();
-  v_set(vc, va);
-  v_set(va, vb);
-  v_set(vb, vc);
-  v_free(vc);
-  v_detach(vc);
+  // exchange the values without copying them
+  v_init(&vc);
+  v_move(&vc, va);
+  v_init(va);
+  v_move(va, vb);
+  v_init(vb);
+  v_move(vb, &vc);
 }
 
 /**
@@ -2866,6 +3372,7 @@ void cmd_end_try() {
  */
 void cmd_call_vfunc() {
   var_t *map = NULL;
+  bcip_t ip = prog_ip;
   var_t *v_func = code_getvarptr_map(&map);
   if (v_func == NULL || (v_func->type != V_FUNC && v_func->type != V_PTR)) {
     rt_raise(ERR_NO_FUNC);
@@ -2874,8 +3381,11 @@ void cmd_call_vfunc() {
     if (code_peek() == kwTYPE_PARAM) {
       code_skipnext();
       cmd_param();
+      int lock = !code_is_plainvar(ip, map);
       var_t *self = v_set_self(map);
+      v_share_lock += lock;
       bc_loop(2);
+      v_share_lock -= lock;
       v_set_self(self);
     } else {
       rt_raise(ERR_NO_FUNC);
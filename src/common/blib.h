@@ -33,6 +33,11 @@ void cmd_param(void);
 int cmd_exit(void);
 void cmd_let(int);
 void cmd_let_opt();
+void cmd_let_add_int();
+void cmd_let_elem_int();
+void cmd_let_append();
+void cmd_tail_call();
+void cmd_print_var();
 void cmd_packed_let();
 void cmd_dim(int);
 void cmd_redim(void);
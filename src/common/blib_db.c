@@ -26,11 +26,13 @@
 
 struct file_encoded_var {
   byte sign;     // always '$'
-  byte version;  //
+  byte version;  // 2 for a packed array
   byte type;     //
   uint32_t size; //
 };
 
+#define ENCODED_VAR_PACKED 2
+
 /*
  * OPEN "file" [FOR {INPUT|OUTPUT|APPEND}] AS #fileN
  */
@@ -76,7 +78,7 @@ void cmd_fopen() {
       int handle = par_getint();
       if (!prog_error) {
         if (dev_fstatus(handle) == 0) {
-          dev_fopen(handle, file_name.v.p.ptr, flags);
+          dev_fopen(handle, v_strptr(&file_name), flags);
         } else {
           rt_raise("OPEN: FILE IS ALREADY OPENED");
         }
@@ -151,13 +153,19 @@ void write_encoded_var(int handle, var_t *var) {
     dev_fwrite(handle, (byte *)&var->v.n, fv.size);
     break;
   case V_STR:
-    fv.size = strlen(var->v.p.ptr);
+    fv.size = strlen(v_strptr(var));
     dev_fwrite(handle, (byte *)&fv, sizeof(struct file_encoded_var));
-    dev_fwrite(handle, (byte *)var->v.p.ptr, fv.size);
+    dev_fwrite(handle, (byte *)v_strptr(var), fv.size);
     break;
   case V_ARRAY:
     fv.size = v_asize(var);
-    dev_fwrite(handle, (byte *)&fv, sizeof(struct file_encoded_var));
+    if (v_is_packed(var)) {
+      fv.version = ENCODED_VAR_PACKED;
+      dev_fwrite(handle, (byte *)&fv, sizeof(struct file_encoded_var));
+      dev_fwrite(handle, &var->pack_type, 1);
+    } else {
+      dev_fwrite(handle, (byte *)&fv, sizeof(struct file_encoded_var));
+    }
 
     // write additional data about array
     dev_fwrite(handle, &v_maxdim(var), 1);
@@ -167,9 +175,13 @@ void write_encoded_var(int handle, var_t *var) {
     }
 
     // write elements
-    for (int i = 0; i < v_asize(var); i++) {
-      var_t *elem = v_elem(var, i);
-      write_encoded_var(handle, elem);
+    if (v_is_packed(var)) {
+      dev_fwrite(handle, (byte *)v_data(var), fv.size * OS_INTSZ);
+    } else {
+      for (int i = 0; i < v_asize(var); i++) {
+        var_t *elem = v_elem(var, i);
+        write_encoded_var(handle, elem);
+      }
     }
     break;
   };
@@ -198,26 +210,45 @@ int read_encoded_var(int handle, var_t *var) {
     dev_fread(handle, (byte *)&var->v.n, fv.size);
     break;
   case V_STR:
-    var->type = V_STR;
-    var->v.p.ptr = malloc(fv.size + 1);
-    dev_fread(handle, (byte *)var->v.p.ptr, fv.size);
-    var->v.p.ptr[fv.size] = '\0';
+    v_init_str(var, fv.size);
+    dev_fread(handle, (byte *)v_strptr(var), fv.size);
+    v_strptr(var)[fv.size] = '\0';
     break;
   case V_ARRAY:
-    v_new_array(var, fv.size);
+    if (fv.version == ENCODED_VAR_PACKED) {
+      byte pack_type = V_PACK_NONE;
+      dev_fread(handle, &pack_type, 1);
+      if (pack_type != V_PACK_INT && pack_type != V_PACK_NUM) {
+        rt_raise("READ: BAD SIGNATURE");
+        return -1;
+      }
+      v_new_packed_array(var, fv.size, pack_type);
+    } else {
+      v_new_array(var, fv.size);
+    }
 
     // read additional data about array
-    dev_fread(handle, &v_maxdim(var), 1);
+    byte maxdim = 0;
+    dev_fread(handle, &maxdim, 1);
+    if (maxdim < 1 || maxdim > MAXDIM) {
+      rt_raise("READ: BAD SIGNATURE");
+      return -1;
+    }
+    v_set_maxdim(var, maxdim);
     for (int i = 0; i < v_maxdim(var); i++) {
       dev_fread(handle, (byte *)&v_lbound(var, i), sizeof(int));
       dev_fread(handle, (byte *)&v_ubound(var, i), sizeof(int));
     }
 
-    // write elements
-    for (int i = 0; i < v_asize(var); i++) {
-      var_t *elem = v_elem(var, i);
-      v_init(elem);
-      read_encoded_var(handle, elem);
+    // read elements
+    if (v_is_packed(var)) {
+      dev_fread(handle, (byte *)v_data(var), fv.size * OS_INTSZ);
+    } else {
+      for (int i = 0; i < v_asize(var); i++) {
+        var_t *elem = v_elem(var, i);
+        v_init(elem);
+        read_encoded_var(handle, elem);
+      }
     }
     break;
   default:
@@ -347,6 +378,7 @@ void cmd_read_variable(int handle) {
 
       var_p->type = V_STR;
       var_p->v.p.ptr = malloc(size);
+      var_p->v.p.owner = V_STR_OWNER;
 
       // READ IT
       while (!dev_feof(handle)) {
@@ -364,11 +396,11 @@ void cmd_read_variable(int handle) {
             size += BUFMAX;
             var_p->v.p.ptr = realloc(var_p->v.p.ptr, size);
           }
-          var_p->v.p.ptr[index] = ch;
+          v_strptr(var_p)[index] = ch;
           index++;
         }
       }
-      var_p->v.p.ptr[index] = '\0';
+      v_strptr(var_p)[index] = '\0';
       var_p->v.p.length = index + 1;
     }
   }
@@ -406,8 +438,9 @@ void cmd_flineinput() {
       v_free(var_p);
       var_p->type = V_STR;
       var_p->v.p.ptr = calloc(SB_TEXTLINE_SIZE + 1, 1);
-      dev_gets(var_p->v.p.ptr, SB_TEXTLINE_SIZE);
-      var_p->v.p.length = strlen(var_p->v.p.ptr);
+      var_p->v.p.owner = V_STR_OWNER;
+      dev_gets(v_strptr(var_p), SB_TEXTLINE_SIZE);
+      var_p->v.p.length = strlen(v_strptr(var_p));
       dev_print("\n");
     }
   }
@@ -425,8 +458,8 @@ void cmd_fkill() {
   if (prog_error) {
     return;
   }
-  if (dev_fexists(file_name.v.p.ptr)) {
-    dev_fremove(file_name.v.p.ptr);
+  if (dev_fexists(v_strptr(&file_name))) {
+    dev_fremove(v_strptr(&file_name));
   }
   v_free(&file_name);
 }
@@ -455,11 +488,11 @@ void cmd_filecp(int mv) {
     return;
   }
 
-  if (dev_fexists(src.v.p.ptr)) {
+  if (dev_fexists(v_strptr(&src))) {
     if (!mv) {
-      dev_fcopy(src.v.p.ptr, dst.v.p.ptr);
+      dev_fcopy(v_strptr(&src), v_strptr(&dst));
     } else {
-      dev_frename(src.v.p.ptr, dst.v.p.ptr);
+      dev_frename(v_strptr(&src), v_strptr(&dst));
     }
   } else {
     rt_raise("COPY/RENAME: FILE DOES NOT EXIST");
@@ -480,7 +513,7 @@ void cmd_chdir() {
   if (prog_error) {
     return;
   }
-  dev_chdir(dir.v.p.ptr);
+  dev_chdir(v_strptr(&dir));
   v_free(&dir);
 }
 
@@ -496,7 +529,7 @@ void cmd_rmdir() {
   if (prog_error) {
     return;
   }
-  dev_rmdir(dir.v.p.ptr);
+  dev_rmdir(v_strptr(&dir));
   v_free(&dir);
 }
 
@@ -512,7 +545,7 @@ void cmd_mkdir() {
   if (prog_error) {
     return;
   }
-  dev_mkdir(dir.v.p.ptr);
+  dev_mkdir(v_strptr(&dir));
   v_free(&dir);
 }
 
@@ -575,7 +608,7 @@ void cmd_floadln() {
     if (v_strlen(&file_name) == 0) {
       err_throw(FSERR_NOT_FOUND);
     } else {
-      dev_fopen(handle, file_name.v.p.ptr, flags);
+      dev_fopen(handle, v_strptr(&file_name), flags);
     }
     v_free(&file_name);
     CHK_ERR(FSERR_GENERIC);
@@ -627,7 +660,7 @@ void cmd_floadln() {
             size += GROW_SIZE;
             var_p->v.p.ptr = realloc(var_p->v.p.ptr, size);
           }
-          var_p->v.p.ptr[bcount] = ch;
+          v_strptr(var_p)[bcount] = ch;
           bcount++;
         }
       }                         // read line
@@ -640,7 +673,7 @@ void cmd_floadln() {
       }
 
       // store text-line
-      var_p->v.p.ptr[bcount] = '\0';
+      v_strptr(var_p)[bcount] = '\0';
       var_p->v.p.length = bcount + 1;
       var_p->v.p.ptr = realloc(var_p->v.p.ptr, var_p->v.p.length);
 
@@ -662,8 +695,8 @@ void cmd_floadln() {
     int len = dev_flength(handle);
     v_init_str(var_p, len);
     if (var_p->v.p.length > 1) {
-      dev_fread(handle, (byte *)var_p->v.p.ptr, var_p->v.p.length - 1);
-      var_p->v.p.ptr[var_p->v.p.length - 1] = '\0';
+      dev_fread(handle, (byte *)v_strptr(var_p), var_p->v.p.length - 1);
+      v_strptr(var_p)[var_p->v.p.length - 1] = '\0';
     }    
   }
   if (flags == DEV_FILE_INPUT) {
@@ -708,7 +741,7 @@ void cmd_fsaveln() {
       return;
     }
 
-    int success = dev_fopen(handle, file_name.v.p.ptr, flags);
+    int success = dev_fopen(handle, v_strptr(&file_name), flags);
     v_free(&file_name);
     CHK_ERR(FSERR_GENERIC);
     if (!success) {
@@ -773,7 +806,7 @@ void cmd_chmod() {
     return;
   }
 
-  chmod(str.v.p.ptr, mode);
+  chmod(v_strptr(&str), mode);
   v_free(&str);
 }
 
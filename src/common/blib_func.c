@@ -835,63 +835,63 @@ void cmd_ns1(long funcCode, var_t *arg, var_t *r) {
     // int <- ASC(s)
     //
     r->type = V_INT;
-    r->v.i = *((byte *) arg->v.p.ptr);
+    r->v.i = *((byte *) v_strptr(arg));
     break;
   case kwVAL:
     //
     // float <- VAL(s)
     //
     r->type = V_NUM;
-    r->v.n = numexpr_sb_strtof(arg->v.p.ptr);
+    r->v.n = numexpr_sb_strtof(v_strptr(arg));
     break;
   case kwTEXTWIDTH:
     //
     // int <- TXTW(s)
     //
     r->type = V_INT;
-    r->v.i = dev_textwidth(arg->v.p.ptr);
+    r->v.i = dev_textwidth(v_strptr(arg));
     break;
   case kwTEXTHEIGHT:
     //
     // int <- TXTH(s)
     //
     r->type = V_INT;
-    r->v.i = dev_textheight(arg->v.p.ptr);
+    r->v.i = dev_textheight(v_strptr(arg));
     break;
   case kwEXIST:
     //
     // int <- EXIST(s)
     //
     r->type = V_INT;
-    r->v.i = dev_fexists(arg->v.p.ptr);
+    r->v.i = dev_fexists(v_strptr(arg));
     break;
   case kwACCESSF:
     //
     // int <- ACCESS(s)
     //
     r->type = V_INT;
-    r->v.i = dev_faccess(arg->v.p.ptr);
+    r->v.i = dev_faccess(v_strptr(arg));
     break;
   case kwISFILE:
     //
     // int <- ISFILE(s)
     //
     r->type = V_INT;
-    r->v.i = dev_fattr(arg->v.p.ptr) & VFS_ATTR_FILE;
+    r->v.i = dev_fattr(v_strptr(arg)) & VFS_ATTR_FILE;
     break;
   case kwISDIR:
     //
     // int <- ISDIR(s)
     //
     r->type = V_INT;
-    r->v.i = dev_fattr(arg->v.p.ptr) & VFS_ATTR_DIR;
+    r->v.i = dev_fattr(v_strptr(arg)) & VFS_ATTR_DIR;
     break;
   case kwISLINK:
     //
     // int <- ISLINK(s)
     //
     r->type = V_INT;
-    r->v.i = dev_fattr(arg->v.p.ptr) & VFS_ATTR_LINK;
+    r->v.i = dev_fattr(v_strptr(arg)) & VFS_ATTR_LINK;
     break;
   default:
     rt_raise("Unsupported built-in function call %ld", funcCode);
@@ -912,17 +912,17 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
     //
     // str <- CHR$(n)
     //
-    wp = r->v.p.ptr = (char *)malloc(2);
+    v_init_str(r, 1);
+    wp = v_strptr(r);
     wp[0] = v_getint(arg);
     wp[1] = '\0';
-    r->v.p.length = 2;
     break;
   case kwSTR:
     //
     // str <- STR$(n)
     //
     r->v.p.ptr = v_str(arg);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwCBS:
     //
@@ -933,8 +933,8 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
       v_init(r);
       break;
     }
-    r->v.p.ptr = cstrdup(arg->v.p.ptr);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    r->v.p.ptr = cstrdup(v_strptr(arg));
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwBCS:
     //
@@ -945,16 +945,16 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
       v_init(r);
       break;
     }
-    r->v.p.ptr = bstrdup(arg->v.p.ptr);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    r->v.p.ptr = bstrdup(v_strptr(arg));
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwOCT:
     //
     // str <- OCT$(n)
     //
     r->v.p.ptr = (char *)malloc(BUF_LEN);
-    sprintf(r->v.p.ptr, "%lo", (unsigned long) v_getint(arg));
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    sprintf(v_strptr(r), "%lo", (unsigned long) v_getint(arg));
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
     //
     // str <- BIN$(n)
@@ -994,16 +994,16 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
     // str <- HEX$(n)
     //
     r->v.p.ptr = (char *)malloc(BUF_LEN);
-    sprintf(r->v.p.ptr, "%lX", (unsigned long) v_getint(arg));
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    sprintf(v_strptr(r), "%lX", (unsigned long) v_getint(arg));
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwLCASE:
     //
     // str <- LCASE$(s)
     //
     r->v.p.ptr = v_str(arg);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
-    p = r->v.p.ptr;
+    r->v.p.length = strlen(v_strptr(r)) + 1;
+    p = v_strptr(r);
     while (*p) {
       *p = to_lower(*p);
       p++;
@@ -1014,8 +1014,8 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
     // str <- UCASE$(s)
     //
     r->v.p.ptr = v_str(arg);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
-    p = r->v.p.ptr;
+    r->v.p.length = strlen(v_strptr(r)) + 1;
+    p = v_strptr(r);
     while (*p) {
       *p = to_upper(*p);
       p++;
@@ -1029,13 +1029,13 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
       v_set(r, arg);
       break;
     }
-    p = arg->v.p.ptr;
+    p = v_strptr(arg);
     while (is_wspace(*p)) {
       p++;
     }
     r->v.p.ptr = (char *)malloc(strlen(p) + 1);
-    strcpy(r->v.p.ptr, p);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    strcpy(v_strptr(r), p);
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwTRIM:
     //
@@ -1049,58 +1049,58 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
       v_set(r, arg);
       break;
     }
-    p = arg->v.p.ptr;
-    uint32_t len = strlen(arg->v.p.ptr);
+    p = v_strptr(arg);
+    uint32_t len = strlen(v_strptr(arg));
     if (*p != '\0') {
       p = p + len - 1; 
-      while (p >= arg->v.p.ptr && is_wspace(*p)) {
+      while (p >= v_strptr(arg) && is_wspace(*p)) {
         len--;      
         p--;
       }
     }
     r->v.p.ptr = (char *)malloc(len + 1);
-    strncpy(r->v.p.ptr, arg->v.p.ptr, len);
-    r->v.p.ptr[len] = '\0';
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    strncpy(v_strptr(r), v_strptr(arg), len);
+    v_strptr(r)[len] = '\0';
+    r->v.p.length = strlen(v_strptr(r)) + 1;
 
     // alltrim
     if (funcCode == kwTRIM) {
-      char *tmp_p = p = r->v.p.ptr;
+      char *tmp_p = p = v_strptr(r);
       while (is_wspace(*p)) {
         p++;
       }
       r->v.p.ptr = (char *)malloc(strlen(p) + 1);
-      strcpy(r->v.p.ptr, p);
-      r->v.p.length = strlen(r->v.p.ptr) + 1;
+      strcpy(v_strptr(r), p);
+      r->v.p.length = strlen(v_strptr(r)) + 1;
       free(tmp_p);
     }
     break;
   case kwCAT:
     // we can add color codes
     r->v.p.ptr = malloc(8);
-    strcpy(r->v.p.ptr, "");
+    strcpy(v_strptr(r), "");
     l = v_getint(arg);
     switch (l) {
     case 0:                    // reset
-      strcpy(r->v.p.ptr, "\033[0m");
+      strcpy(v_strptr(r), "\033[0m");
       break;
     case 1:                    // bold on
-      strcpy(r->v.p.ptr, "\033[1m");
+      strcpy(v_strptr(r), "\033[1m");
       break;
     case -1:                   // bold off
-      strcpy(r->v.p.ptr, "\033[21m");
+      strcpy(v_strptr(r), "\033[21m");
       break;
     case 2:                    // underline on
-      strcpy(r->v.p.ptr, "\033[4m");
+      strcpy(v_strptr(r), "\033[4m");
       break;
     case -2:                   // underline off
-      strcpy(r->v.p.ptr, "\033[24m");
+      strcpy(v_strptr(r), "\033[24m");
       break;
     case 3:                    // reverse on
-      strcpy(r->v.p.ptr, "\033[7m");
+      strcpy(v_strptr(r), "\033[7m");
       break;
     case -3:                   // reverse off
-      strcpy(r->v.p.ptr, "\033[27m");
+      strcpy(v_strptr(r), "\033[27m");
       break;
     case 80:                   // select system font
     case 81:
@@ -1112,7 +1112,7 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
     case 87:
     case 88:
     case 89:
-      sprintf(r->v.p.ptr, "\033[8%dm", (int) l - 80);
+      sprintf(v_strptr(r), "\033[8%dm", (int) l - 80);
       break;
     case 90:                   // select custom font
     case 91:
@@ -1125,17 +1125,17 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
     case 98:
     case 99:
       if (os_charset == 0)
-        sprintf(r->v.p.ptr, "\033[9%dm", (int) l - 90);
+        sprintf(v_strptr(r), "\033[9%dm", (int) l - 90);
       break;
     }
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwTAB:
     l = v_igetval(arg);
     r->v.p.ptr = malloc(16);
     *r->v.p.ptr = '\0';
-    sprintf(r->v.p.ptr, "\033[%dG", (int) l);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    sprintf(v_strptr(r), "\033[%dG", (int) l);
+    r->v.p.length = strlen(v_strptr(r)) + 1;
    break;
   case kwSPACE:
     //
@@ -1150,20 +1150,20 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
         wp[i] = ' ';
       }
       wp[l] = '\0';
-      r->v.p.length = strlen(r->v.p.ptr) + 1;
+      r->v.p.length = strlen(v_strptr(r)) + 1;
     }
     break;
   case kwENVIRONF:
     //
     // str <- ENVIRON$(str)
     //
-    if (v_is_type(arg, V_STR) && *arg->v.p.ptr != '\0') {
+    if (v_is_type(arg, V_STR) && *v_strptr(arg) != '\0') {
       // return the variable
-      const char *v = dev_getenv(arg->v.p.ptr);
+      const char *v = dev_getenv(v_strptr(arg));
       if (v) {
         int l = strlen(v) + 1;
         r->v.p.ptr = malloc(l);
-        strcpy(r->v.p.ptr, v);
+        strcpy(v_strptr(r), v);
         r->v.p.length = l;
       } else {
         r->v.p.ptr = malloc(2);
@@ -1181,7 +1181,7 @@ void cmd_str1(long funcCode, var_t *arg, var_t *r) {
           var_t *elem_p = v_elem(r, i);
           elem_p->type = V_STR;
           elem_p->v.p.ptr = strdup(value != NULL ? value : "");
-          elem_p->v.p.length = strlen(elem_p->v.p.ptr) + 1;
+          elem_p->v.p.length = strlen(v_strptr(elem_p)) + 1;
         }
       } else {
         // no vars found
@@ -1305,8 +1305,8 @@ void cmd_str0(long funcCode, var_t *r) {
     r->type = V_STR;
     r->v.p.ptr = malloc(32);
     r->v.p.owner = 1;
-    sprintf(r->v.p.ptr, "%02d/%02d/%04d", tms.tm_mday, tms.tm_mon + 1, tms.tm_year + 1900);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    sprintf(v_strptr(r), "%02d/%02d/%04d", tms.tm_mday, tms.tm_mon + 1, tms.tm_year + 1900);
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   case kwTIME:
     //
@@ -1317,8 +1317,8 @@ void cmd_str0(long funcCode, var_t *r) {
     r->type = V_STR;
     r->v.p.ptr = malloc(32);
     r->v.p.owner = 1;
-    sprintf(r->v.p.ptr, "%02d:%02d:%02d", tms.tm_hour, tms.tm_min, tms.tm_sec);
-    r->v.p.length = strlen(r->v.p.ptr) + 1;
+    sprintf(v_strptr(r), "%02d:%02d:%02d", tms.tm_hour, tms.tm_min, tms.tm_sec);
+    r->v.p.length = strlen(v_strptr(r)) + 1;
     break;
   default:
     rt_raise("Unsupported built-in function call %ld", funcCode);
@@ -1352,7 +1352,7 @@ void cmd_strN(long funcCode, var_t *r) {
         r->v.p.ptr = transdup(s1, s2, "", i);
       }
       r->type = V_STR;
-      r->v.p.length = strlen(r->v.p.ptr) + 1;
+      r->v.p.length = strlen(v_strptr(r)) + 1;
     }
     break;
   case kwCHOP:
@@ -1363,9 +1363,9 @@ void cmd_strN(long funcCode, var_t *r) {
     if (!prog_error) {
       if (strlen(s1)) {
         r->v.p.ptr = strdup(s1);
-        r->v.p.ptr[strlen(r->v.p.ptr) - 1] = '\0';
+        v_strptr(r)[strlen(v_strptr(r)) - 1] = '\0';
         r->type = V_STR;
-        r->v.p.length = strlen(r->v.p.ptr) + 1;
+        r->v.p.length = strlen(v_strptr(r)) + 1;
       } else {
         v_zerostr(r);
       }
@@ -1398,11 +1398,11 @@ void cmd_strN(long funcCode, var_t *r) {
         r->type = V_INT;        // dont try to free
       } else {
         r->v.p.ptr = malloc(count * len + 1);
-        *((r->v.p.ptr)) = '\0';
+        *((v_strptr(r))) = '\0';
         for (int i = 0; i < count; i++) {
-          strcat(r->v.p.ptr, tmp_p);
+          strcat(v_strptr(r), tmp_p);
         }
-        r->v.p.length = strlen(r->v.p.ptr) + 1;
+        r->v.p.length = strlen(v_strptr(r)) + 1;
       }
     }
     break;
@@ -1415,7 +1415,7 @@ void cmd_strN(long funcCode, var_t *r) {
     if (!prog_error) {
       r->type = V_STR;
       r->v.p.ptr = sqzdup(s1);
-      r->v.p.length = strlen(r->v.p.ptr) + 1;
+      r->v.p.length = strlen(v_strptr(r)) + 1;
     }
     break;
     //
@@ -1430,7 +1430,7 @@ void cmd_strN(long funcCode, var_t *r) {
       } else {
         r->v.p.ptr = encldup(s1, "\"\"");
       }
-      r->v.p.length = strlen(r->v.p.ptr) + 1;
+      r->v.p.length = strlen(v_strptr(r)) + 1;
     }
     break;
     //
@@ -1475,7 +1475,7 @@ void cmd_strN(long funcCode, var_t *r) {
           r->v.p.ptr = discldup(s1, "\"\"", "''");
         }
       }
-      r->v.p.length = strlen(r->v.p.ptr) + 1;
+      r->v.p.length = strlen(v_strptr(r)) + 1;
     }
     break;
 
@@ -1485,8 +1485,8 @@ void cmd_strN(long funcCode, var_t *r) {
     // Win32: use & at the end of the command to run-it in background
     //
     par_getstr(&arg1);
-    if (!prog_error && !dev_run(arg1.v.p.ptr, r, 1)) {
-      rt_raise(ERR_RUNFUNC_FILE, arg1.v.p.ptr);
+    if (!prog_error && !dev_run(v_strptr(&arg1), r, 1)) {
+      rt_raise(ERR_RUNFUNC_FILE, v_strptr(&arg1));
     }
     break;
 
@@ -1504,10 +1504,9 @@ void cmd_strN(long funcCode, var_t *r) {
       if (count < 0) {
         count = 0;
       }
-      r->v.p.ptr = malloc(count + 1);
-      memcpy(r->v.p.ptr, s1, count);
-      r->v.p.ptr[count] = '\0';
-      r->v.p.length = count + 1;
+      v_init_str(r, count);
+      memcpy(v_strptr(r), s1, count);
+      v_strptr(r)[count] = '\0';
     }
     break;
 
@@ -1523,7 +1522,7 @@ void cmd_strN(long funcCode, var_t *r) {
         *p = '\0';
         int l = strlen(s1) + 1;
         r->v.p.ptr = malloc(l);
-        strcpy(r->v.p.ptr, s1);
+        strcpy(v_strptr(r), s1);
         r->v.p.length = l;
         *p = lc;
       } else {
@@ -1546,10 +1545,9 @@ void cmd_strN(long funcCode, var_t *r) {
       if (count < 0) {
         count = 0;
       }
-      r->v.p.ptr = malloc(count + 1);
-      memcpy(r->v.p.ptr, s1 + (len - count), count + 1);
-      r->v.p.ptr[count] = '\0';
-      r->v.p.length = count + 1;
+      v_init_str(r, count);
+      memcpy(v_strptr(r), s1 + (len - count), count + 1);
+      v_strptr(r)[count] = '\0';
     }
     break;
 
@@ -1564,7 +1562,7 @@ void cmd_strN(long funcCode, var_t *r) {
         p += strlen(s2);
         int l = strlen(p) + 1;
         r->v.p.ptr = malloc(l);
-        memcpy(r->v.p.ptr, p, l);
+        memcpy(v_strptr(r), p, l);
         r->v.p.length = l;
       } else {
         v_zerostr(r);
@@ -1591,7 +1589,7 @@ void cmd_strN(long funcCode, var_t *r) {
         *p = '\0';
         int l = strlen(s1) + 1;
         r->v.p.ptr = malloc(l);
-        memcpy(r->v.p.ptr, s1, l);
+        memcpy(v_strptr(r), s1, l);
         r->v.p.length = l;
         *p = lc;
       } else {
@@ -1618,7 +1616,7 @@ void cmd_strN(long funcCode, var_t *r) {
         p += l2;
         int l = strlen(p) + 1;
         r->v.p.ptr = malloc(l);
-        memcpy(r->v.p.ptr, p, l);
+        memcpy(v_strptr(r), p, l);
         r->v.p.length = l;
       } else {
         v_zerostr(r);
@@ -1668,21 +1666,21 @@ void cmd_strN(long funcCode, var_t *r) {
       r->v.p.ptr = malloc(r->v.p.length);
 
       // copy the left side of "source"
-      memcpy(r->v.p.ptr, var_p1->v.p.ptr, start);
+      memcpy(v_strptr(r), v_strptr(var_p1), start);
 
       // insert "str"
-      r->v.p.ptr[start] = '\0';
+      v_strptr(r)[start] = '\0';
 
       if (str != NULL) {
-        strcat(r->v.p.ptr, str);
+        strcat(v_strptr(r), str);
         free(str);
       } else {
-        strcat(r->v.p.ptr, var_p2->v.p.ptr);
+        strcat(v_strptr(r), v_strptr(var_p2));
       }
 
       // add the remainder of "source" startin at index "count"
       if (start + count < len_source) {
-        strcat(r->v.p.ptr, var_p1->v.p.ptr + start + count);
+        strcat(v_strptr(r), v_strptr(var_p1) + start + count);
       }
     }
     v_free(&arg2);
@@ -1706,10 +1704,9 @@ void cmd_strN(long funcCode, var_t *r) {
           len = lsrc - start;
         }
       }
-      r->v.p.ptr = malloc(len + 1);
-      memcpy(r->v.p.ptr, var_p1->v.p.ptr + start, len);
-      r->v.p.ptr[len] = '\0';
-      r->v.p.length = len + 1;
+      v_init_str(r, len);
+      memcpy(v_strptr(r), v_strptr(var_p1) + start, len);
+      v_strptr(r)[len] = '\0';
     }
     break;
 
@@ -1811,7 +1808,7 @@ void cmd_intN(long funcCode, var_t *r) {
         var_int_t lv = 0;
         var_num_t dv = 0;
 
-        np = get_numexpr(var_p->v.p.ptr, buf, &type, &lv, &dv);
+        np = get_numexpr(v_strptr(var_p), buf, &type, &lv, &dv);
 
         if (type == 1 && *np == '\0') {
           r->v.i = (funcCode == kwISSTRING) ? 0 : 1;
@@ -2095,15 +2092,15 @@ void cmd_genfunc(long funcCode, var_t *r) {
         if (!prog_error) {
           switch (arg2.type) {
           case V_STR:
-            buf = format_str(arg.v.p.ptr, arg2.v.p.ptr);
+            buf = format_str(v_strptr(&arg), v_strptr(&arg2));
             v_setstr(r, buf);
             break;
           case V_INT:
-            buf = format_num(arg.v.p.ptr, arg2.v.i);
+            buf = format_num(v_strptr(&arg), arg2.v.i);
             v_setstr(r, buf);
             break;
           case V_NUM:
-            buf = format_num(arg.v.p.ptr, arg2.v.n);
+            buf = format_num(v_strptr(&arg), arg2.v.n);
             v_setstr(r, buf);
             break;
           default:
@@ -2130,7 +2127,7 @@ void cmd_genfunc(long funcCode, var_t *r) {
     IF_ERR_RETURN;
 
     if (arg.type == V_STR) {
-      date_str2dmy(arg.v.p.ptr, &d, &m, &y);
+      date_str2dmy(v_strptr(&arg), &d, &m, &y);
       v_free(&arg);
     } else {
       d = v_igetval(&arg);
@@ -2178,7 +2175,7 @@ void cmd_genfunc(long funcCode, var_t *r) {
     v_init(&arg2);
     eval(&arg2);
     if (arg2.type == V_STR) {
-      date_str2dmy(arg2.v.p.ptr, &d, &m, &y);
+      date_str2dmy(v_strptr(&arg2), &d, &m, &y);
       v_free(&arg2);
     } else {
       d = v_igetval(&arg2);
@@ -2212,7 +2209,7 @@ void cmd_genfunc(long funcCode, var_t *r) {
 
     if (funcCode == kwDATEFMT) {
       // format
-      v_move_str(r, date_fmt(arg.v.p.ptr, d, m, y));
+      v_move_str(r, date_fmt(v_strptr(&arg), d, m, y));
       v_free(&arg);
     } else {
       // weekday
@@ -2240,7 +2237,7 @@ void cmd_genfunc(long funcCode, var_t *r) {
       // keyboard
       r->type = V_STR;
       r->v.p.ptr = malloc((count << 1) + 1);
-      r->v.p.ptr[0] = '\0';
+      v_strptr(r)[0] = '\0';
       r->v.p.owner = 1;
       len = 0;
       char tmp[3];
@@ -2267,16 +2264,16 @@ void cmd_genfunc(long funcCode, var_t *r) {
           len++;
         }
 
-        strcat(r->v.p.ptr, tmp);
+        strcat(v_strptr(r), tmp);
       }
 
       r->v.p.length = len + 1;
-      r->v.p.ptr[len] = '\0';
+      v_strptr(r)[len] = '\0';
     } else {
       // file
       v_init_str(r, count);
-      dev_fread(handle, (byte *)r->v.p.ptr, count);
-      r->v.p.ptr[count] = '\0';
+      dev_fread(handle, (byte *)v_strptr(r), count);
+      v_strptr(r)[count] = '\0';
     }
 
     break;
@@ -2559,7 +2556,8 @@ void cmd_genfunc(long funcCode, var_t *r) {
           if (!prog_error && basevar_p->type == V_ARRAY) {
             count = v_asize(basevar_p);
             for (int i = 0; i < count; i++) {
-              var_t *elem_p = v_elem(basevar_p, i);
+              var_t tmp;
+              var_t *elem_p = v_array_get(basevar_p, i, &tmp);
               if (!prog_error) {
                 if (first) {
                   dar_first(funcCode, r, elem_p);
@@ -2631,7 +2629,8 @@ void cmd_genfunc(long funcCode, var_t *r) {
           if (!prog_error && basevar_p->type == V_ARRAY) {
             count = v_asize(basevar_p);
             for (int i = 0; i < count; i++) {
-              var_t *elem_p = v_elem(basevar_p, i);
+              var_t tmp;
+              var_t *elem_p = v_array_get(basevar_p, i, &tmp);
               if (!prog_error) {
                 if (tcount >= len) {
                   len += BUF_LEN;
@@ -2814,7 +2813,8 @@ void cmd_genfunc(long funcCode, var_t *r) {
       for (int32_t y = 0; y < rows; y++) {
         pos1 = y * cols + x;
         pos2 = x * rows + y;        
-        e = v_elem(a, pos1);
+        var_t tmp;
+        e = v_array_get(a, pos1, &tmp);
         m[pos2] = v_getval(e);
       }
     }
@@ -2874,7 +2874,7 @@ void cmd_genfunc(long funcCode, var_t *r) {
     v_init(&arg);
     if (code_peek() != kwTYPE_LEVEL_END) {
       par_getstr(&arg);
-      wc = arg.v.p.ptr;
+      wc = v_strptr(&arg);
     }
 
     if (!prog_error) {
@@ -2889,7 +2889,7 @@ void cmd_genfunc(long funcCode, var_t *r) {
         for (int i = 0; i < count; i++) {
           var_t *elem_p = v_elem(r, i);
           v_init_str(elem_p, strlen(list[i]));
-          strcpy(elem_p->v.p.ptr, list[i]);
+          strcpy(v_strptr(elem_p), list[i]);
         }
       } else {
         v_toarray1(r, 0);
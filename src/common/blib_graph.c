@@ -665,7 +665,7 @@ void cmd_draw() {
   if (prog_error) {
     return;
   }
-  p = var.v.p.ptr;
+  p = v_strptr(&var);
   while (*p) {
 
     // 'N' command must affect only the next drawing command.
@@ -99,8 +99,8 @@ void cmd_play() {
   if (prog_error) {
     return;
   }
-  if (strncmp("file://", var.v.p.ptr, FILE_PREFIX_LEN) == 0) {
-    const char *path = var.v.p.ptr + FILE_PREFIX_LEN;
+  if (strncmp("file://", v_strptr(&var), FILE_PREFIX_LEN) == 0) {
+    const char *path = v_strptr(&var) + FILE_PREFIX_LEN;
     if (dev_fexists(path)) {
       dev_audio(path);
     } else {
@@ -113,7 +113,7 @@ void cmd_play() {
   str = (char *) malloc(var.v.p.length + 1);
 
   // copy without spaces
-  p = var.v.p.ptr;
+  p = v_strptr(&var);
   s = str;
   while (*p) {
     if (*p > 32) {
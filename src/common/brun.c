@@ -26,14 +26,62 @@
 #include "common/pproc.h"
 #include "common/keymap.h"
 
+#if defined(_UnixOS) && !defined(__MINGW32__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define BRUN_MMAP
+#endif
+
 int brun_create_task(const char *filename, byte *preloaded_bc, int libf);
 int exec_close_task();
+int exec_close(int tid);
 void sys_before_comp();
+bcip_t comp_next_bc_cmd(bc_t *bc, bcip_t ip);
 
 static char fileName[OS_FILENAME_SIZE + 1];
 static stknode_t err_node;
 
 #define EVT_CHECK_EVERY 50
+#define EVT_BUDGET_MAX 4096
+#define EVT_PROBE_EVERY 64
+
+// bc_loop() only reads the clock once evt_budget statements have run. a
+// batch of more than EVT_PROBE_EVERY statements is split into probes which
+// end the batch early once it has taken longer than EVT_CHECK_EVERY
+static int evt_budget;
+static int evt_remaining;
+static int evt_interval;
+static uint32_t evt_last;
+static uint32_t evt_next_check;
+
+// when built with USE_COMPUTED_GOTO, bc_loop() jumps straight to the
+// handler label through bc_dispatch[] rather than via the switch
+#if defined(USE_COMPUTED_GOTO)
+#define BC_TARGET(c) case c: bc_##c
+#define BC_SWITCH(c) goto *bc_dispatch[c]; switch (c)
+// each handler dispatches the next command itself, the loop head is only
+// used for the event check, the end of the code or an error
+#define BC_NEXT                                                   \
+  if (!prog_error && prog_ip < prog_length && --evt_budget > 0) { \
+    code = prog_source[prog_ip++];                                \
+    goto *bc_dispatch[code];                                      \
+  }                                                               \
+  continue
+// a command followed by kwTYPE_EOC or kwTYPE_LINE dispatches the separator
+// as the next command, anything else takes the checked path after the switch
+#define BC_BREAK                                                  \
+  if (!prog_error && prog_ip < prog_length &&                     \
+      (prog_source[prog_ip] == kwTYPE_EOC ||                      \
+       prog_source[prog_ip] == kwTYPE_LINE)) {                    \
+    BC_NEXT;                                                      \
+  }                                                               \
+  break
+#else
+#define BC_TARGET(c) case c
+#define BC_SWITCH(c) switch (c)
+#define BC_NEXT continue
+#define BC_BREAK break
+#endif
 #define IF_ERR_BREAK if (prog_error) { \
   if (prog_error == errThrow)       \
       prog_error = errNone; else break;}
@@ -45,12 +93,36 @@ void code_jump_label(uint16_t label_id) {
   prog_ip = tlab[label_id].ip;
 }
 
+/**
+ * Grows the stack up to opt_stack_limit nodes, returns 0 when full
+ */
+static int code_grow_stack() {
+  uint32_t limit = opt_stack_limit > 0 ? opt_stack_limit : SB_EXEC_STACK_LIMIT;
+  int result = 0;
+  if (prog_stack_alloc < limit) {
+    uint32_t size = prog_stack_alloc * 2;
+    if (size > limit) {
+      size = limit;
+    }
+    stknode_t *stack = realloc(prog_stack, sizeof(stknode_t) * size);
+    if (stack != NULL) {
+      prog_stack = stack;
+      prog_stack_alloc = size;
+      result = 1;
+    }
+  }
+  return result;
+}
+
 /**
  * Push a new node onto the stack
+ *
+ * the stack may move when it grows, pointers from code_push() or
+ * code_stackpeek() are only valid until the next push
  */
 stknode_t *code_push(code_t type) {
   stknode_t *result;
-  if (prog_stack_count + 1 >= prog_stack_alloc) {
+  if (prog_stack_count + 1 >= prog_stack_alloc && !code_grow_stack()) {
     err_stackoverflow();
     result = &err_node;
   } else {
@@ -72,15 +144,8 @@ void free_node(stknode_t *node) {
     }
     break;
 
-  case kwBYREF:
-    tvar[node->x.vdvar.vid] = node->x.vdvar.vptr;
-    break;
-
   case kwTYPE_VAR:
-    if ((node->x.param.vcheck == 1) || (node->x.param.vcheck == 0x81)) {
-      v_free(node->x.param.res);
-      v_detach(node->x.param.res);
-    }
+    // by value parameters are owned by the frame of the call
     break;
 
   case kwTYPE_RET:
@@ -90,6 +155,7 @@ void free_node(stknode_t *node) {
 
   case kwFUNC:
   case kwPROC:
+    frame_release(node->x.vcall.frame);
     if (node->x.vcall.rvid != INVALID_ADDR) {
       v_detach(tvar[node->x.vcall.rvid]);
       tvar[node->x.vcall.rvid] = node->x.vcall.retvar;
@@ -181,6 +247,70 @@ stknode_t *code_stackpeek() {
   return NULL;
 }
 
+/**
+ * Returns the frame variable at the given index
+ */
+frame_var_t *frame_at(uint32_t index) {
+  uint32_t mask = (1 << SB_FRAME_BLOCK_BITS) - 1;
+  return &prog_frames[index >> SB_FRAME_BLOCK_BITS][index & mask];
+}
+
+/**
+ * Adds a new empty variable to the frame stack
+ */
+frame_var_t *frame_push() {
+  uint32_t block = prog_frame_count >> SB_FRAME_BLOCK_BITS;
+  if (block == prog_frame_blocks) {
+    // blocks are never moved since tvar may point to their variables
+    prog_frames = realloc(prog_frames, sizeof(frame_var_t *) * (block + 1));
+    prog_frames[block] = malloc(sizeof(frame_var_t) << SB_FRAME_BLOCK_BITS);
+    prog_frame_blocks++;
+  }
+  frame_var_t *result = frame_at(prog_frame_count++);
+  v_init(&result->var);
+  result->vptr = NULL;
+  result->vid = -1;
+  result->share_lock = 0;
+  return result;
+}
+
+/**
+ * Makes tvar[vid] refer to var until the frame variable is released
+ */
+void frame_bind(frame_var_t *fv, bid_t vid, var_t *var) {
+  fv->vid = vid;
+  fv->vptr = tvar[vid];
+  tvar[vid] = var;
+}
+
+/**
+ * Releases the frame variables from base upwards
+ */
+void frame_release(uint32_t base) {
+  while (prog_frame_count > base) {
+    frame_var_t *fv = frame_at(--prog_frame_count);
+    if (fv->vid != -1) {
+      tvar[fv->vid] = fv->vptr;
+    }
+    if (fv->share_lock) {
+      v_share_lock--;
+    }
+    v_free(&fv->var);
+  }
+}
+
+/**
+ * Releases the frame variables in [base, top) and moves the rest down
+ */
+void frame_drop(uint32_t base, uint32_t top) {
+  uint32_t count = prog_frame_count;
+  prog_frame_count = top;
+  frame_release(base);
+  for (uint32_t i = top; i < count; i++) {
+    *frame_at(prog_frame_count++) = *frame_at(i);
+  }
+}
+
 /**
  * sets the value of an system-variable with the given type
  */
@@ -329,6 +459,54 @@ void brun_break() {
   brun_stop();
 }
 
+/**
+ * check for events before the next statement
+ */
+void brun_poll_events() {
+  evt_budget = 0;
+  evt_remaining = 0;
+}
+
+/**
+ * reset the event checker at the start of the program
+ */
+static void evt_init() {
+  evt_last = dev_get_millisecond_count();
+  evt_next_check = evt_last + EVT_CHECK_EVERY;
+  evt_interval = 1;
+  evt_budget = 1;
+  evt_remaining = 0;
+}
+
+/**
+ * returns the statements to run before the next probe of the given batch
+ */
+static int evt_probe(int batch) {
+  int result = batch < EVT_PROBE_EVERY ? batch : EVT_PROBE_EVERY;
+  evt_remaining = batch - result;
+  return result;
+}
+
+/**
+ * returns the number of statements to run before the clock is read again.
+ * the interval doubles while statements are cheap and drops back to one
+ * once a batch takes longer than the event check period
+ */
+static int evt_next_budget(uint32_t now) {
+  int limit = opt_event_budget > 0 ? opt_event_budget : EVT_BUDGET_MAX;
+  uint32_t elapsed = now - evt_last;
+  evt_last = now;
+  if (elapsed >= EVT_CHECK_EVERY) {
+    evt_interval = 1;
+  } else if (elapsed < EVT_CHECK_EVERY / 4) {
+    evt_interval *= 2;
+  }
+  if (evt_interval > limit) {
+    evt_interval = limit;
+  }
+  return evt_probe(evt_interval);
+}
+
 /**
  * CHAIN sb-source
  */
@@ -345,9 +523,9 @@ void cmd_chain(void) {
   }
 
   if (var.type == V_STR) {
-    if (access(var.v.p.ptr, R_OK) == 0) {
+    if (access(v_strptr(&var), R_OK) == 0) {
       // argument is a file name
-      int h = open(var.v.p.ptr, O_BINARY | O_RDONLY);
+      int h = open(v_strptr(&var), O_BINARY | O_RDONLY);
       if (h != -1) {
         struct stat st;
         if (fstat(h, &st) == 0) {
@@ -360,24 +538,21 @@ void cmd_chain(void) {
       }
     }
     if (!code) {
-      code = strdup(var.v.p.ptr);
+      code = strdup(v_strptr(&var));
     }
   } else if (var.type == V_ARRAY) {
+    // join the lines, appending at the known length
     int len = 0;
     uint32_t size = v_asize(&var);
     for (int el = 0; el < size; el++) {
       var_t *el_p = v_elem(&var, el);
       if (el_p->type == V_STR) {
-        int str_len = strlen(el_p->v.p.ptr) + 2;
-        if (len) {
-          code = realloc(code, len + str_len);
-          strcat(code, el_p->v.p.ptr);
-        } else {
-          code = malloc(str_len);
-          strcpy(code, el_p->v.p.ptr);
-        }
-        strcat(code, "\n");
-        len += str_len + 1;
+        int str_len = strlen(v_strptr(el_p));
+        code = realloc(code, len + str_len + 2);
+        memcpy(code + len, v_strptr(el_p), str_len);
+        len += str_len;
+        code[len++] = '\n';
+        code[len] = '\0';
       }
     }
   }
@@ -417,8 +592,7 @@ void cmd_chain(void) {
 
   bc_loop(0);
   success = prog_error;         // save tid_main status
-  exec_close_task();            // cleanup task data - tid_main
-  close_task(tid_main);         // cleanup task container
+  exec_close(tid_main);         // cleanup tid_main and the units it loaded
   close_task(tid_base);         // cleanup task container
   activate_task(tid_prev);      // resume calling task
 
@@ -447,7 +621,7 @@ void cmd_run(int retf) {
     err_typemismatch();
     return;
   } else {
-    strlcpy(fileName, var.v.p.ptr, sizeof(fileName));
+    strlcpy(fileName, v_strptr(&var), sizeof(fileName));
     v_free(&var);
   }
 
@@ -708,20 +882,96 @@ void bc_loop_goto() {
 
 /**
  * execute commands (loop)
- *
- * @param isf if 1, the program must return if found return (by level <= 0);
- * otherwise an RTE will generated
- * if 2; like 1, but increase the proc_level because UDF call executed internaly
  */
-void bc_loop(int isf) {
+static void bc_loop_run(int isf) {
   byte pops;
   int i;
   int proc_level = 0;
   byte code = 0;
 
-  // setup event checker time = 50ms
-  uint32_t now = dev_get_millisecond_count();
-  uint32_t next_check = now + EVT_CHECK_EVERY;
+#if defined(USE_COMPUTED_GOTO)
+  static const void *const bc_dispatch[256] = {
+    [0 ... 255] = &&bc_default,
+    [kwLABEL] = &&bc_kwLABEL,
+    [kwREM] = &&bc_kwREM,
+    [kwTYPE_EOC] = &&bc_kwTYPE_EOC,
+    [kwTYPE_LINE] = &&bc_kwTYPE_LINE,
+    [kwLET] = &&bc_kwLET,
+    [kwLET_OPT] = &&bc_kwLET_OPT,
+    [kwLET_ADD_INT] = &&bc_kwLET_ADD_INT,
+    [kwLET_ELEM_INT] = &&bc_kwLET_ELEM_INT,
+    [kwLET_APPEND] = &&bc_kwLET_APPEND,
+    [kwTAIL_CALL] = &&bc_kwTAIL_CALL,
+    [kwPRINT_VAR] = &&bc_kwPRINT_VAR,
+    [kwCONST] = &&bc_kwCONST,
+    [kwPACKED_LET] = &&bc_kwPACKED_LET,
+    [kwGOTO] = &&bc_kwGOTO,
+    [kwGOSUB] = &&bc_kwGOSUB,
+    [kwRETURN] = &&bc_kwRETURN,
+    [kwONJMP] = &&bc_kwONJMP,
+    [kwPRINT] = &&bc_kwPRINT,
+    [kwINPUT] = &&bc_kwINPUT,
+    [kwIF] = &&bc_kwIF,
+    [kwELIF] = &&bc_kwELIF,
+    [kwELSE] = &&bc_kwELSE,
+    [kwENDIF] = &&bc_kwENDIF,
+    [kwFOR] = &&bc_kwFOR,
+    [kwNEXT] = &&bc_kwNEXT,
+    [kwWHILE] = &&bc_kwWHILE,
+    [kwWEND] = &&bc_kwWEND,
+    [kwREPEAT] = &&bc_kwREPEAT,
+    [kwUNTIL] = &&bc_kwUNTIL,
+    [kwSELECT] = &&bc_kwSELECT,
+    [kwCASE] = &&bc_kwCASE,
+    [kwCASE_ELSE] = &&bc_kwCASE_ELSE,
+    [kwENDSELECT] = &&bc_kwENDSELECT,
+    [kwDIM] = &&bc_kwDIM,
+    [kwREDIM] = &&bc_kwREDIM,
+    [kwAPPEND] = &&bc_kwAPPEND,
+    [kwINSERT] = &&bc_kwINSERT,
+    [kwDELETE] = &&bc_kwDELETE,
+    [kwERASE] = &&bc_kwERASE,
+    [kwREAD] = &&bc_kwREAD,
+    [kwDATA] = &&bc_kwDATA,
+    [kwRESTORE] = &&bc_kwRESTORE,
+    [kwOPTION] = &&bc_kwOPTION,
+    [kwTYPE_CALLEXTP] = &&bc_kwTYPE_CALLEXTP,
+    [kwTYPE_CALLP] = &&bc_kwTYPE_CALLP,
+    [kwTYPE_CALL_UDP] = &&bc_kwTYPE_CALL_UDP,
+    [kwTYPE_CALL_UDF] = &&bc_kwTYPE_CALL_UDF,
+    [kwTYPE_RET] = &&bc_kwTYPE_RET,
+    [kwTYPE_CRVAR] = &&bc_kwTYPE_CRVAR,
+    [kwTYPE_PARAM] = &&bc_kwTYPE_PARAM,
+    [kwEXIT] = &&bc_kwEXIT,
+    [kwLINE] = &&bc_kwLINE,
+    [kwCOLOR] = &&bc_kwCOLOR,
+    [kwOPEN] = &&bc_kwOPEN,
+    [kwCLOSE] = &&bc_kwCLOSE,
+    [kwFILEWRITE] = &&bc_kwFILEWRITE,
+    [kwFILEREAD] = &&bc_kwFILEREAD,
+    [kwLOGPRINT] = &&bc_kwLOGPRINT,
+    [kwFILEPRINT] = &&bc_kwFILEPRINT,
+    [kwSPRINT] = &&bc_kwSPRINT,
+    [kwLINEINPUT] = &&bc_kwLINEINPUT,
+    [kwSINPUT] = &&bc_kwSINPUT,
+    [kwFILEINPUT] = &&bc_kwFILEINPUT,
+    [kwSEEK] = &&bc_kwSEEK,
+    [kwTRON] = &&bc_kwTRON,
+    [kwTROFF] = &&bc_kwTROFF,
+    [kwSTOP] = &&bc_kwSTOP,
+    [kwEND] = &&bc_kwEND,
+    [kwCHAIN] = &&bc_kwCHAIN,
+    [kwRUN] = &&bc_kwRUN,
+    [kwEXEC] = &&bc_kwEXEC,
+    [kwTRY] = &&bc_kwTRY,
+    [kwCATCH] = &&bc_kwCATCH,
+    [kwENDTRY] = &&bc_kwENDTRY
+  };
+#endif
+
+  if (isf == 0) {
+    evt_init();
+  }
 
   /**
    * For commands that change the IP use
@@ -735,184 +985,198 @@ void bc_loop(int isf) {
     proc_level++;
   }
   while (prog_ip < prog_length) {
-    switch (code) {
-    case kwLABEL:
-    case kwREM:
-    case kwTYPE_EOC:
-    case kwTYPE_LINE:
-      break;
-    default:
-      now = dev_get_millisecond_count();
-      break;
-    }
-
-    // check events every ~50ms
-    if (now >= next_check) {
-      next_check = now + EVT_CHECK_EVERY;
+    // check events every ~50ms, reading the clock once the budget runs out
+    if (--evt_budget <= 0) {
+      uint32_t now = dev_get_millisecond_count();
+      if (evt_remaining > 0 && now - evt_last < EVT_CHECK_EVERY) {
+        // partway through a batch which is still within the period
+        evt_budget = evt_probe(evt_remaining);
+      } else {
+        evt_budget = evt_next_budget(now);
+      }
+      if (now >= evt_next_check) {
+        evt_next_check = now + EVT_CHECK_EVERY;
 
-      switch (dev_events(0)) {
-      case -1:
-        // break event
-        break;
-      case -2:
-        prog_error = errBreak;
-        inf_break(prog_line);
-        break;
-      default:
-        if (prog_timer) {
-          timer_run(now);
-        }
-      };
+        switch (dev_events(0)) {
+        case -1:
+          // break event
+          break;
+        case -2:
+          prog_error = errBreak;
+          inf_break(prog_line);
+          break;
+        default:
+          if (prog_timer) {
+            timer_run(now);
+          }
+        };
+      }
     }
 
     // proceed to the next command
     if (!prog_error) {
       code = prog_source[prog_ip++];
-      switch (code) {
-      case kwLABEL:
-      case kwREM:
-      case kwTYPE_EOC:
-        continue;
-      case kwTYPE_LINE:
+      BC_SWITCH(code) {
+      BC_TARGET(kwLABEL):
+      BC_TARGET(kwREM):
+      BC_TARGET(kwTYPE_EOC):
+        BC_NEXT;
+      BC_TARGET(kwTYPE_LINE):
         prog_line = code_getaddr();
         if (opt_trace_on) {
           dev_trace_line(prog_line);
         }
-        continue;
-      case kwLET:
+        BC_NEXT;
+      BC_TARGET(kwLET):
         cmd_let(0);
-        break;
-      case kwLET_OPT:
+        BC_BREAK;
+      BC_TARGET(kwLET_OPT):
         cmd_let_opt();
-        break;
-      case kwCONST:
+        BC_BREAK;
+      BC_TARGET(kwLET_ADD_INT):
+        cmd_let_add_int();
+        BC_BREAK;
+      BC_TARGET(kwLET_ELEM_INT):
+        cmd_let_elem_int();
+        BC_BREAK;
+      BC_TARGET(kwLET_APPEND):
+        cmd_let_append();
+        BC_BREAK;
+      BC_TARGET(kwTAIL_CALL):
+        cmd_tail_call();
+        IF_ERR_BREAK;
+        BC_NEXT;
+      BC_TARGET(kwCONST):
         cmd_let(1);
-        break;
-      case kwPACKED_LET:
+        BC_BREAK;
+      BC_TARGET(kwPACKED_LET):
         cmd_packed_let();
-        break;
-      case kwGOTO:
+        BC_BREAK;
+      BC_TARGET(kwGOTO):
         bc_loop_goto();
-        continue;
-      case kwGOSUB:
+        BC_NEXT;
+      BC_TARGET(kwGOSUB):
         cmd_gosub();
         IF_ERR_BREAK;
-        continue;
-      case kwRETURN:
+        BC_NEXT;
+      BC_TARGET(kwRETURN):
         cmd_return();
         IF_ERR_BREAK;
-        continue;
-      case kwONJMP:
+        BC_NEXT;
+      BC_TARGET(kwONJMP):
         cmd_on_go();
         IF_ERR_BREAK;
-        continue;
-      case kwPRINT:
+        BC_NEXT;
+      BC_TARGET(kwPRINT):
         cmd_print(PV_CONSOLE);
-        break;
-      case kwINPUT:
+        BC_BREAK;
+      BC_TARGET(kwPRINT_VAR):
+        cmd_print_var();
+        BC_BREAK;
+      BC_TARGET(kwINPUT):
         cmd_input(PV_CONSOLE);
-        break;
-      case kwIF:
+        BC_BREAK;
+      BC_TARGET(kwIF):
         cmd_if();
         IF_ERR_BREAK;
-        continue;
-      case kwELIF:
+        BC_NEXT;
+      BC_TARGET(kwELIF):
         cmd_elif();
         IF_ERR_BREAK;
-        continue;
-      case kwELSE:
+        BC_NEXT;
+      BC_TARGET(kwELSE):
         cmd_else();
         IF_ERR_BREAK;
-        continue;
-      case kwENDIF:
+        BC_NEXT;
+      BC_TARGET(kwENDIF):
         cmd_endif();
         IF_ERR_BREAK;
-        continue;
-      case kwFOR:
+        BC_NEXT;
+      BC_TARGET(kwFOR):
         cmd_for();
         IF_ERR_BREAK;
-        continue;
-      case kwNEXT:
+        BC_NEXT;
+      BC_TARGET(kwNEXT):
         cmd_next();
         IF_ERR_BREAK;
-        continue;
-      case kwWHILE:
+        BC_NEXT;
+      BC_TARGET(kwWHILE):
         cmd_while();
         IF_ERR_BREAK;
-        continue;
-      case kwWEND:
+        BC_NEXT;
+      BC_TARGET(kwWEND):
         cmd_wend();
         IF_ERR_BREAK;
-        continue;
-      case kwREPEAT:
+        BC_NEXT;
+      BC_TARGET(kwREPEAT):
         cmd_repeat();
         IF_ERR_BREAK;
-        continue;
-      case kwUNTIL:
+        BC_NEXT;
+      BC_TARGET(kwUNTIL):
         cmd_until();
         IF_ERR_BREAK;
-        continue;
-      case kwSELECT:
+        BC_NEXT;
+      BC_TARGET(kwSELECT):
         cmd_select();
         IF_ERR_BREAK;
-        continue;
-      case kwCASE:
+        BC_NEXT;
+      BC_TARGET(kwCASE):
         cmd_case();
         IF_ERR_BREAK;
-        continue;
-      case kwCASE_ELSE:
+        BC_NEXT;
+      BC_TARGET(kwCASE_ELSE):
         cmd_case_else();
         IF_ERR_BREAK;
-        continue;
-      case kwENDSELECT:
+        BC_NEXT;
+      BC_TARGET(kwENDSELECT):
         cmd_end_select();
         IF_ERR_BREAK;
-        continue;
-      case kwDIM:
+        BC_NEXT;
+      BC_TARGET(kwDIM):
         cmd_dim(0);
-        break;
-      case kwREDIM:
+        BC_BREAK;
+      BC_TARGET(kwREDIM):
         cmd_redim();
-        break;
-      case kwAPPEND:
+        BC_BREAK;
+      BC_TARGET(kwAPPEND):
         cmd_append();
-        break;
-      case kwINSERT:
+        BC_BREAK;
+      BC_TARGET(kwINSERT):
         cmd_lins();
-        break;
-      case kwDELETE:
+        BC_BREAK;
+      BC_TARGET(kwDELETE):
         cmd_ldel();
-        break;
-      case kwERASE:
+        BC_BREAK;
+      BC_TARGET(kwERASE):
         cmd_erase();
-        break;
-      case kwREAD:
+        BC_BREAK;
+      BC_TARGET(kwREAD):
         cmd_read();
-        break;
-      case kwDATA:
+        BC_BREAK;
+      BC_TARGET(kwDATA):
         cmd_data();
-        break;
-      case kwRESTORE:
+        BC_BREAK;
+      BC_TARGET(kwRESTORE):
         cmd_restore();
-        break;
-      case kwOPTION:
+        BC_BREAK;
+      BC_TARGET(kwOPTION):
         cmd_options();
-        break;
-      case kwTYPE_CALLEXTP:
+        BC_BREAK;
+      BC_TARGET(kwTYPE_CALLEXTP):
         bc_loop_call_extp();
         IF_ERR_BREAK;
-        continue;
-      case kwTYPE_CALLP:
+        BC_NEXT;
+      BC_TARGET(kwTYPE_CALLP):
         bc_loop_call_proc();
-        break;
-      case kwTYPE_CALL_UDP:
+        BC_BREAK;
+      BC_TARGET(kwTYPE_CALL_UDP):
         cmd_udp(kwPROC);
         if (isf) {
           proc_level++;
         }
         IF_ERR_BREAK;
-        continue;
-      case kwTYPE_CALL_UDF:
+        BC_NEXT;
+      BC_TARGET(kwTYPE_CALL_UDF):
         if (isf) {
           cmd_udp(kwFUNC);
           proc_level++;
@@ -920,8 +1184,8 @@ void bc_loop(int isf) {
           err_syntax(kwTYPE_CALL_UDF, "%G");
         }
         IF_ERR_BREAK;
-        continue;
-      case kwTYPE_RET:
+        BC_NEXT;
+      BC_TARGET(kwTYPE_RET):
         cmd_udpret();
         if (isf) {
           proc_level--;
@@ -930,14 +1194,14 @@ void bc_loop(int isf) {
           }
         }
         IF_ERR_BREAK;
-        continue;
-      case kwTYPE_CRVAR:
+        BC_NEXT;
+      BC_TARGET(kwTYPE_CRVAR):
         cmd_crvar();
-        break;
-      case kwTYPE_PARAM:
+        BC_BREAK;
+      BC_TARGET(kwTYPE_PARAM):
         cmd_param();
-        break;
-      case kwEXIT:
+        BC_BREAK;
+      BC_TARGET(kwEXIT):
         pops = cmd_exit();
         if (isf && pops) {
           proc_level--;
@@ -946,77 +1210,80 @@ void bc_loop(int isf) {
           }
         }
         IF_ERR_BREAK;
-        continue;
-      case kwLINE:
+        BC_NEXT;
+      BC_TARGET(kwLINE):
         cmd_line();
-        break;
-      case kwCOLOR:
+        BC_BREAK;
+      BC_TARGET(kwCOLOR):
         cmd_color();
-        break;
-      case kwOPEN:
+        BC_BREAK;
+      BC_TARGET(kwOPEN):
         cmd_fopen();
-        break;
-      case kwCLOSE:
+        BC_BREAK;
+      BC_TARGET(kwCLOSE):
         cmd_fclose();
-        break;
-      case kwFILEWRITE:
+        BC_BREAK;
+      BC_TARGET(kwFILEWRITE):
         cmd_fwrite();
-        break;
-      case kwFILEREAD:
+        BC_BREAK;
+      BC_TARGET(kwFILEREAD):
         cmd_fread();
-        break;
-      case kwLOGPRINT:
+        BC_BREAK;
+      BC_TARGET(kwLOGPRINT):
         cmd_print(PV_LOG);
-        break;
-      case kwFILEPRINT:
+        BC_BREAK;
+      BC_TARGET(kwFILEPRINT):
         cmd_print(PV_FILE);
-        break;
-      case kwSPRINT:
+        BC_BREAK;
+      BC_TARGET(kwSPRINT):
         cmd_print(PV_STRING);
-        break;
-      case kwLINEINPUT:
+        BC_BREAK;
+      BC_TARGET(kwLINEINPUT):
         cmd_flineinput();
-        break;
-      case kwSINPUT:
+        BC_BREAK;
+      BC_TARGET(kwSINPUT):
         cmd_input(PV_STRING);
-        break;
-      case kwFILEINPUT:
+        BC_BREAK;
+      BC_TARGET(kwFILEINPUT):
         cmd_input(PV_FILE);
-        break;
-      case kwSEEK:
+        BC_BREAK;
+      BC_TARGET(kwSEEK):
         cmd_fseek();
-        break;
-      case kwTRON:
+        BC_BREAK;
+      BC_TARGET(kwTRON):
         opt_trace_on = 1;
-        continue;
-      case kwTROFF:
+        BC_NEXT;
+      BC_TARGET(kwTROFF):
         opt_trace_on = 0;
-        continue;
-      case kwSTOP:
-      case kwEND:
+        BC_NEXT;
+      BC_TARGET(kwSTOP):
+      BC_TARGET(kwEND):
         bc_loop_end();
-        break;
-      case kwCHAIN:
+        BC_BREAK;
+      BC_TARGET(kwCHAIN):
         cmd_chain();
-        break;
-      case kwRUN:
+        BC_BREAK;
+      BC_TARGET(kwRUN):
         cmd_run(1);
-        break;
-      case kwEXEC:
+        BC_BREAK;
+      BC_TARGET(kwEXEC):
         cmd_run(0);
-        break;
-      case kwTRY:
+        BC_BREAK;
+      BC_TARGET(kwTRY):
         cmd_try();
         IF_ERR_BREAK;
-        continue;
-      case kwCATCH:
+        BC_NEXT;
+      BC_TARGET(kwCATCH):
         cmd_catch();
         IF_ERR_BREAK;
-        continue;
-      case kwENDTRY:
+        BC_NEXT;
+      BC_TARGET(kwENDTRY):
         cmd_end_try();
-        continue;
+        BC_NEXT;
       default:
+#if defined(USE_COMPUTED_GOTO)
+      bc_default:
+#endif
         log_printf("OUT OF ADDRESS SPACE\n");
         for (i = 0; keyword_table[i].name[0] != '\0'; i++) {
           if (prog_source[prog_ip] == keyword_table[i].code) {
@@ -1051,9 +1318,32 @@ void bc_loop(int isf) {
     }
     // quit on error
     IF_ERR_BREAK;
+    BC_NEXT;
   }
 }
 
+/**
+ * execute commands (loop)
+ *
+ * @param isf if 1, the program must return if found return (by level <= 0);
+ * otherwise an RTE will generated
+ * if 2; like 1, but increase the proc_level because UDF call executed internaly
+ */
+void bc_loop(int isf) {
+  // every FUNC in an expression, map method, unit call or event handler
+  // runs a nested bc_loop() on the C stack, so bound the nesting before
+  // the executor stack limit is reached. a unit call may leave ctask
+  // switched, so release the depth of the task which was entered
+  int tid = ctask->tid;
+  if (prog_loop_depth >= SB_EXEC_LOOP_DEPTH) {
+    err_stackoverflow();
+    return;
+  }
+  prog_loop_depth++;
+  bc_loop_run(isf);
+  taskinfo(tid)->sbe.exec.loop_depth--;
+}
+
 /**
  * debug info
  * stack dump
@@ -1086,6 +1376,59 @@ void dump_stack() {
   } while (1);
 }
 
+/**
+ * creates the field cache with at least two slots for each kwTYPE_UDS_EL
+ * call site
+ */
+static void brun_create_fieldcache() {
+  uint32_t field_sites = 0;
+  bc_t bc;
+
+  bc.ptr = prog_source;
+  bc.count = prog_length;
+  for (bcip_t ip = 0; ip < prog_length; ip = comp_next_bc_cmd(&bc, ip)) {
+    if (prog_source[ip] == kwTYPE_UDS_EL) {
+      field_sites++;
+    }
+  }
+
+  uint32_t field_size = 1;
+  while (field_size < field_sites * 2) {
+    field_size <<= 1;
+  }
+  prog_fieldmask = field_size - 1;
+  prog_fieldcache = calloc(field_size, sizeof(field_cache_t));
+}
+
+#if defined(BRUN_MMAP)
+/**
+ * maps the compiled file as private copy-on-write pages. the pages are
+ * shared through the page cache with other processes running the same file
+ * until they are written, which only happens for the pages holding the lib
+ * and symbol tables. the file is mapped over zeroed anonymous pages, so the
+ * 4 bytes past the end stay readable like the slack of the allocated copy.
+ * returns NULL when the file is shorter than length or can't be mapped,
+ * otherwise the mapping size in mapsize
+ */
+static byte *brun_map_file(int h, uint32_t length, size_t *mapsize) {
+  struct stat st;
+  byte *result = NULL;
+  if (fstat(h, &st) == 0 && st.st_size > 0 && st.st_size >= length) {
+    size_t size = st.st_size + 4;
+    byte *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base != MAP_FAILED) {
+      if (mmap(base, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, h, 0) != MAP_FAILED) {
+        *mapsize = size;
+        result = base;
+      } else {
+        munmap(base, size);
+      }
+    }
+  }
+  return result;
+}
+#endif
+
 // load libraries - each library is loaded on new task
 void brun_load_libraries(int tid) {
   // reset symbol mapping
@@ -1166,6 +1509,7 @@ int brun_create_task(const char *filename, byte *preloaded_bc, int libf) {
   bc_head_t hdr;
   unit_file_t uft;
   byte *source;
+  size_t mapsize = 0;
   char fname[OS_PATHNAME_SIZE + 1];
 
   if (preloaded_bc) {
@@ -1192,30 +1536,65 @@ int brun_create_task(const char *filename, byte *preloaded_bc, int libf) {
     if (search_task(fname) != -1) {
       return search_task(fname);
     }
-    // open & load
-    int h = open(fname, O_RDWR | O_BINARY);
-    if (h == -1) {
-      panic("File '%s' not found", fname);
-    }
-    // load it
     if (libf) {
-      read(h, &uft, sizeof(unit_file_t));
-      lseek(h, sizeof(unit_sym_t) * uft.sym_count, SEEK_CUR);
-    }
-    read(h, &hdr, sizeof(bc_head_t));
-    if (hdr.sbver != SB_DWORD_VER) {
-      panic("File '%s' version incorrect", fname);
+      // check the unit in the unit cache, which keeps it between runs
+      uint32_t size;
+      const byte *image = unit_cache_get(fname, &size);
+      if (image == NULL || size < sizeof(unit_file_t)) {
+        panic("File '%s' not found", fname);
+      }
+      memcpy(&uft, image, sizeof(unit_file_t));
+      uint32_t offset = sizeof(unit_file_t) + sizeof(unit_sym_t) * uft.sym_count;
+      if (uft.sym_count < 0 || size < offset + sizeof(bc_head_t)) {
+        panic("File '%s' version incorrect", fname);
+      }
+      memcpy(&hdr, image + offset, sizeof(bc_head_t));
+      if (hdr.sbver != SB_DWORD_VER || hdr.size > size) {
+        panic("File '%s' version incorrect", fname);
+      }
+      source = NULL;
+#if defined(BRUN_MMAP)
+      // the task's pages are shared with the cached mapping until loading
+      // patches them
+      int h = unit_cache_open(fname);
+      if (h != -1) {
+        source = brun_map_file(h, hdr.size, &mapsize);
+        close(h);
+      }
+#endif
+      if (source == NULL) {
+        source = malloc(hdr.size + 4);
+        memcpy(source, image, hdr.size);
+      }
+    } else {
+      // open & load
+      int h = open(fname, O_RDONLY | O_BINARY);
+      if (h == -1) {
+        panic("File '%s' not found", fname);
+      }
+      read(h, &hdr, sizeof(bc_head_t));
+      if (hdr.sbver != SB_DWORD_VER) {
+        panic("File '%s' version incorrect", fname);
+      }
+#if defined(BRUN_MMAP)
+      source = brun_map_file(h, hdr.size, &mapsize);
+#else
+      source = NULL;
+#endif
+      if (source == NULL) {
+        source = malloc(hdr.size + 4);
+        lseek(h, 0, SEEK_SET);
+        read(h, source, hdr.size);
+      }
+      close(h);
     }
-    source = malloc(hdr.size + 4);
-    lseek(h, 0, SEEK_SET);
-    read(h, source, hdr.size);
-    close(h);
   }
 
   // create task
   int tid = create_task(fname); // create a task
   activate_task(tid);           // make it active
   ctask->bytecode = source;
+  ctask->bc_mapsize = mapsize;
   byte *cp = source;
 
   if (memcmp(source, "SBUn", 4) == 0) { // load a unit
@@ -1224,7 +1603,10 @@ int brun_create_task(const char *filename, byte *preloaded_bc, int libf) {
     prog_expcount = uft.sym_count;
 
     // copy export-symbols from BC
-    if (prog_expcount) {
+    if (prog_expcount && mapsize) {
+      prog_exptable = (unit_sym_t *)cp;
+      cp += prog_expcount * sizeof(unit_sym_t);
+    } else if (prog_expcount) {
       prog_exptable = (unit_sym_t *)malloc(prog_expcount * sizeof(unit_sym_t));
       for (int i = 0; i < prog_expcount; i++) {
         memcpy(&prog_exptable[i], cp, sizeof(unit_sym_t));
@@ -1255,30 +1637,40 @@ int brun_create_task(const char *filename, byte *preloaded_bc, int libf) {
   for (int i = 0; i < prog_varcount; i++) {
     tvar[i] = v_new();
   }
-  // create label-table
-  if (prog_labcount) {
-    tlab = malloc(sizeof(lab_t) * prog_labcount);
-    for (int i = 0; i < prog_labcount; i++) {
-      // copy labels from BC
-      memcpy(&tlab[i].ip, cp, ADDRSZ);
-      cp += ADDRSZ;
+  if (mapsize) {
+    // the tables are used in place, each has 4 byte aligned records
+    tlab = (lab_t *)cp;
+    cp += prog_labcount * ADDRSZ;
+    prog_libtable = (bc_lib_rec_t *)cp;
+    cp += prog_libcount * sizeof(bc_lib_rec_t);
+    prog_symtable = (bc_symbol_rec_t *)cp;
+    cp += prog_symcount * sizeof(bc_symbol_rec_t);
+  } else {
+    // create label-table
+    if (prog_labcount) {
+      tlab = malloc(sizeof(lab_t) * prog_labcount);
+      for (int i = 0; i < prog_labcount; i++) {
+        // copy labels from BC
+        memcpy(&tlab[i].ip, cp, ADDRSZ);
+        cp += ADDRSZ;
+      }
     }
-  }
-  // build import-lib table
-  if (prog_libcount) {
-    prog_libtable = (bc_lib_rec_t *)malloc(prog_libcount * sizeof(bc_lib_rec_t));
-    for (int i = 0; i < prog_libcount; i++) {
-      memcpy(&prog_libtable[i], cp, sizeof(bc_lib_rec_t));
-      cp += sizeof(bc_lib_rec_t);
+    // build import-lib table
+    if (prog_libcount) {
+      prog_libtable = (bc_lib_rec_t *)malloc(prog_libcount * sizeof(bc_lib_rec_t));
+      for (int i = 0; i < prog_libcount; i++) {
+        memcpy(&prog_libtable[i], cp, sizeof(bc_lib_rec_t));
+        cp += sizeof(bc_lib_rec_t);
+      }
     }
-  }
 
-  // build import-symbol table
-  if (prog_symcount) {
-    prog_symtable = (bc_symbol_rec_t *)malloc(prog_symcount * sizeof(bc_symbol_rec_t));
-    for (int i = 0; i < prog_symcount; i++) {
-      memcpy(&prog_symtable[i], cp, sizeof(bc_symbol_rec_t));
-      cp += sizeof(bc_symbol_rec_t);
+    // build import-symbol table
+    if (prog_symcount) {
+      prog_symtable = (bc_symbol_rec_t *)malloc(prog_symcount * sizeof(bc_symbol_rec_t));
+      for (int i = 0; i < prog_symcount; i++) {
+        memcpy(&prog_symtable[i], cp, sizeof(bc_symbol_rec_t));
+        cp += sizeof(bc_symbol_rec_t);
+      }
     }
   }
 
@@ -1288,6 +1680,12 @@ int brun_create_task(const char *filename, byte *preloaded_bc, int libf) {
   prog_stack_count = 0;
   prog_timer = NULL;
 
+  // SUB/FUNC local variables
+  prog_frames = NULL;
+  prog_frame_count = 0;
+  prog_frame_blocks = 0;
+  prog_loop_depth = 0;
+
   // create eval's stack
   eval_size = SB_EVAL_STACK_SIZE;
   eval_stk = malloc(sizeof(var_t) * eval_size);
@@ -1301,6 +1699,7 @@ int brun_create_task(const char *filename, byte *preloaded_bc, int libf) {
   prog_length = hdr.bc_count;
   prog_source = cp;
   prog_ip = 0;
+  brun_create_fieldcache();
 
   exec_setup_predefined_variables();
   if (prog_libcount) {
@@ -1328,6 +1727,15 @@ int exec_close_task() {
       code_pop_and_free();
     }
     free(prog_stack);
+
+    // clean up - locals declared outside of a SUB/FUNC
+    frame_release(0);
+    for (int i = 0; i < (int) prog_frame_blocks; i++) {
+      free(prog_frames[i]);
+    }
+    free(prog_frames);
+    prog_frames = NULL;
+    prog_frame_blocks = 0;
     // clean up - variables
     for (int i = 0; i < (int) prog_varcount; i++) {
       // do not free imported variables
@@ -1350,23 +1758,36 @@ int exec_close_task() {
     free(tvar);
     ctask->has_sysvars = 0;
 
-    // clean up - rest tables
-    if (prog_expcount) {
-      free(prog_exptable);
-    }
-    if (prog_libcount) {
-      free(prog_libtable);
-    }
-    if (prog_symcount) {
-      free(prog_symtable);
-    }
-    if (prog_labcount) {
-      free(tlab);
+    // clean up - rest tables, held in the mapping when it exists
+    if (ctask->bc_mapsize == 0) {
+      if (prog_expcount) {
+        free(prog_exptable);
+      }
+      if (prog_libcount) {
+        free(prog_libtable);
+      }
+      if (prog_symcount) {
+        free(prog_symtable);
+      }
+      if (prog_labcount) {
+        free(tlab);
+      }
     }
 
     // clean up - the rest
+    free(prog_fieldcache);
+#if defined(BRUN_MMAP)
+    if (ctask->bc_mapsize) {
+      munmap(ctask->bytecode, ctask->bc_mapsize);
+    } else {
+      free(ctask->bytecode);
+    }
+#else
     free(ctask->bytecode);
+#endif
     ctask->bytecode = NULL;
+    ctask->bc_mapsize = 0;
+    prog_source = NULL;
 
     // cleanup the keyboard map
     keymap_free();
@@ -1514,6 +1935,189 @@ int sbasic_recursive_exec(int tid) {
   return success;
 }
 
+/**
+ * bytecode cache file header, followed by the dependency records and the
+ * bytecode. each dependency record is a cache_dep_t followed by the file name
+ */
+typedef struct {
+  char sign[4];   /**< always "SBXc" */
+  uint32_t sbver; /**< version of SB */
+  uint64_t key;   /**< the key which names the file */
+  uint32_t count; /**< number of dependency records */
+  uint32_t size;  /**< size of the bytecode */
+} cache_head_t;
+
+typedef struct {
+  uint64_t hash;  /**< hash of the file contents */
+  uint32_t len;   /**< length of the file name */
+} cache_dep_t;
+
+#define CACHE_HASH_INIT 0xcbf29ce484222325ULL
+#define CACHE_NAME_SZ (OPT_CACHE_SZ + 32)
+
+/**
+ * FNV-1a over the given bytes
+ */
+static uint64_t cache_hash(uint64_t hash, const void *data, size_t size) {
+  const byte *p = (const byte *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/**
+ * hashes the contents of the given file, returns 0 when it can't be read
+ */
+static uint64_t cache_hash_file(const char *file) {
+  uint64_t result = 0;
+  int h = open(file, O_BINARY | O_RDONLY);
+  if (h != -1) {
+    byte buf[8192];
+    int len;
+    result = CACHE_HASH_INIT;
+    while ((len = read(h, buf, sizeof(buf))) > 0) {
+      result = cache_hash(result, buf, len);
+    }
+    if (len < 0 || result == 0) {
+      result = 0;
+    }
+    close(h);
+  }
+  return result;
+}
+
+/**
+ * builds the cache file name of the given source. the key covers the
+ * interpreter build and the directories used to find includes and units,
+ * the included files and units are checked against the dependency records
+ */
+static uint64_t cache_file_name(const char *file, char *name, size_t size) {
+  char cwd[OS_PATHNAME_SIZE + 1];
+  uint32_t layout[] = {
+    SB_DWORD_VER, kwNULL, kwNULLPROC, kwNULLFUNC, sizeof(var_t),
+    sizeof(var_int_t), sizeof(var_num_t), sizeof(bcip_t)
+  };
+  uint64_t key = 0;
+  uint64_t hash = cache_hash_file(file);
+  if (hash != 0) {
+    cwd[0] = '\0';
+    getcwd(cwd, sizeof(cwd) - 1);
+    key = cache_hash(CACHE_HASH_INIT, SB_STR_VER, strlen(SB_STR_VER));
+    key = cache_hash(key, layout, sizeof(layout));
+    key = cache_hash(key, &hash, sizeof(hash));
+    key = cache_hash(key, cwd, strlen(cwd) + 1);
+    key = cache_hash(key, gsb_bas_dir, strlen(gsb_bas_dir) + 1);
+    key = cache_hash(key, opt_modpath, strlen(opt_modpath) + 1);
+    key = cache_hash(key, file, strlen(file) + 1);
+    snprintf(name, size, "%s%c%016llx.sbx", opt_cachedir, OS_DIRSEP, (unsigned long long)key);
+  }
+  return key;
+}
+
+/**
+ * loads the bytecode of the given source from the cache, returns NULL when
+ * it is missing or any of the files it was built from has changed
+ */
+static byte *cache_load(const char *name, uint64_t key) {
+  byte *result = NULL;
+  cache_head_t head;
+  int h = open(name, O_BINARY | O_RDONLY);
+  if (h != -1) {
+    int valid = (read(h, &head, sizeof(head)) == sizeof(head) &&
+                 memcmp(head.sign, "SBXc", 4) == 0 &&
+                 head.sbver == SB_DWORD_VER && head.key == key);
+    for (uint32_t i = 0; valid && i < head.count; i++) {
+      char dep_name[OS_PATHNAME_SIZE + 1];
+      cache_dep_t dep;
+      valid = (read(h, &dep, sizeof(dep)) == sizeof(dep) &&
+               dep.len < sizeof(dep_name) &&
+               read(h, dep_name, dep.len) == (int)dep.len);
+      if (valid) {
+        dep_name[dep.len] = '\0';
+        valid = (cache_hash_file(dep_name) == dep.hash);
+      }
+    }
+    if (valid && head.size >= sizeof(bc_head_t)) {
+      result = malloc(head.size + 4);
+      if (read(h, result, head.size) != (int)head.size ||
+          ((bc_head_t *)result)->size != head.size) {
+        free(result);
+        result = NULL;
+      }
+    }
+    close(h);
+  }
+  return result;
+}
+
+/**
+ * writes the bytecode and the files it was built from into the cache. the
+ * file is written under a temporary name then renamed, so a concurrent run
+ * never reads a partial file
+ */
+static void cache_save(const char *name, uint64_t key, const byte *code) {
+  char tmp_name[CACHE_NAME_SZ + 16];
+  cache_head_t head;
+
+  memcpy(head.sign, "SBXc", 4);
+  head.sbver = SB_DWORD_VER;
+  head.key = key;
+  head.count = comp_depend_count();
+  head.size = ((const bc_head_t *)code)->size;
+
+  snprintf(tmp_name, sizeof(tmp_name), "%s.%d.tmp", name, (int)getpid());
+  int h = open(tmp_name, O_BINARY | O_WRONLY | O_TRUNC | O_CREAT, 0660);
+  if (h != -1) {
+    int success = (write(h, &head, sizeof(head)) == sizeof(head));
+    for (uint32_t i = 0; success && i < head.count; i++) {
+      const char *dep_name = comp_depend(i);
+      cache_dep_t dep;
+      memset(&dep, 0, sizeof(dep));
+      dep.len = strlen(dep_name);
+      dep.hash = cache_hash_file(dep_name);
+      success = (dep.hash != 0 &&
+                 write(h, &dep, sizeof(dep)) == sizeof(dep) &&
+                 write(h, dep_name, dep.len) == (int)dep.len);
+    }
+    if (success) {
+      success = (write(h, code, head.size) == (int)head.size);
+    }
+    if (close(h) != 0) {
+      success = 0;
+    }
+    if (!success || rename(tmp_name, name) != 0) {
+      unlink(tmp_name);
+    }
+  }
+}
+
+/**
+ * compile the given file into memory, or load its bytecode from opt_cachedir
+ */
+static int sbasic_compile_cached(const char *file) {
+  char name[CACHE_NAME_SZ];
+  int success;
+  uint64_t key = cache_file_name(file, name, sizeof(name));
+  byte *code = key ? cache_load(name, key) : NULL;
+  if (code != NULL) {
+    ctask->bytecode = code;
+    ctask->bc_type = 1;
+    ctask->error = 0;
+    success = 1;
+  } else {
+    comp_depends_begin();
+    sys_before_comp();
+    success = comp_compile(file);
+    if (success && key && ctask->bc_type == 1 && ctask->bytecode != NULL) {
+      cache_save(name, key, ctask->bytecode);
+    }
+    comp_depends_end();
+  }
+  return success;
+}
+
 /**
  * compile the given file into bytecode
  */
@@ -1525,6 +2129,10 @@ int sbasic_compile(const char *file) {
     return success;             // file is an executable
   }
 
+  if (opt_nosave && opt_cachedir[0]) {
+    return sbasic_compile_cached(file);
+  }
+
   if (opt_nosave) {
     comp_rq = 1;
   } else {
@@ -1575,6 +2183,7 @@ int sbasic_exec_prepare(const char *filename) {
   int taskId;
 
   v_init_pool();
+  v_share_lock = 0;
 
   // load source
   if (opt_nosave) {
@@ -1672,6 +2281,11 @@ int sbasic_exec(const char *file) {
     if (!opt_quiet) {
       inf_done();
     }
+    if (opt_verbose) {
+      var_pool_stats_t stats;
+      v_pool_stats(&stats);
+      log_printf("Var pool: %u in use, %u peak, %u slabs\n", stats.count, stats.high_water, stats.slabs);
+    }
 
     exec_close(exec_tid);       // clean up executor's garbages
     dev_restore();              // restore device
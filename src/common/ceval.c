@@ -9,6 +9,7 @@
 
 #include "common/smbas.h"
 #include "common/bc.h"
+#include "common/blib.h"
 
 static bc_t *bc_in;
 static bc_t *bc_out;
@@ -35,6 +36,304 @@ void cev_opr_err(void) {
   sc_raise("(EXPR): SYNTAX ERROR (%d)", CODE(IP));
 }
 
+/*
+ * returns true when the output between start and end is a single constant,
+ * or a single constant in parenthesis, the value is copied into v
+ */
+int cev_get_const(bcip_t start, bcip_t end, var_t *v) {
+  uint32_t len;
+  int result = 0;
+  if (start < end) {
+    switch (bc_out->ptr[start]) {
+    case kwTYPE_LEVEL_BEGIN:
+      if (bc_out->ptr[end - 1] == kwTYPE_LEVEL_END) {
+        result = cev_get_const(start + 1, end - 1, v);
+      }
+      break;
+    case kwTYPE_INT:
+      if (end == start + 1 + OS_INTSZ) {
+        v->type = V_INT;
+        memcpy(&v->v.i, bc_out->ptr + start + 1, OS_INTSZ);
+        result = 1;
+      }
+      break;
+    case kwTYPE_NUM:
+      if (end == start + 1 + OS_REALSZ) {
+        v->type = V_NUM;
+        memcpy(&v->v.n, bc_out->ptr + start + 1, OS_REALSZ);
+        result = 1;
+      }
+      break;
+    case kwTYPE_STR:
+      memcpy(&len, bc_out->ptr + start + 1, OS_STRLEN);
+      if (end == start + 1 + OS_STRLEN + len) {
+        v_setstrn(v, (const char *)bc_out->ptr + start + 1 + OS_STRLEN, len - 1);
+        result = 1;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return result;
+}
+
+/*
+ * replaces the output from start with the constant v
+ */
+void cev_set_const(bcip_t start, var_t *v) {
+  bc_out->count = start;
+  switch (v->type) {
+  case V_INT:
+    bc_add_cint(bc_out, v->v.i);
+    break;
+  case V_NUM:
+    bc_add_creal(bc_out, v->v.n);
+    break;
+  case V_STR:
+    bc_add_strn(bc_out, v_strptr(v), strlen(v_strptr(v)));
+    break;
+  default:
+    break;
+  }
+}
+
+/*
+ * folds [left] [EVPUSH] [right] when both sides are numeric constants,
+ * matching the run-time rules in eval.c
+ */
+int cev_fold_binary(bcip_t start, bcip_t push, code_t opr, code_t op) {
+  var_t left, right, r;
+  int result = 0;
+
+  v_init(&left);
+  v_init(&right);
+  if (!cev_get_const(start, push, &left) ||
+      !cev_get_const(push + 1, bc_out->count, &right) ||
+      left.type == V_STR || right.type == V_STR) {
+    v_free(&left);
+    v_free(&right);
+    return 0;
+  }
+
+  var_num_t lf = v_getval(&left);
+  var_num_t rf = v_getval(&right);
+  var_int_t li, ri;
+  v_init(&r);
+
+  switch (opr) {
+  case kwTYPE_ADDOPR:
+    if (left.type == V_INT && right.type == V_INT) {
+      r.v.i = (op == '+') ? left.v.i + right.v.i : left.v.i - right.v.i;
+    } else {
+      r.type = V_NUM;
+      r.v.n = (op == '+') ? lf + rf : lf - rf;
+    }
+    result = 1;
+    break;
+  case kwTYPE_MULOPR:
+    switch (op) {
+    case '*':
+      r.type = V_NUM;
+      r.v.n = lf * rf;
+      result = 1;
+      break;
+    case '/':
+      if (ABS(rf) != 0) {
+        r.type = V_NUM;
+        r.v.n = lf / rf;
+        result = 1;
+      }
+      break;
+    case '\\':
+      li = lf;
+      ri = rf;
+      if (ri != 0) {
+        r.v.i = li / ri;
+        result = 1;
+      }
+      break;
+    case '%':
+    case OPLOG_MOD:
+      ri = rf;
+      if (ri != 0) {
+        li = (lf < 0.0) ? -floor(-lf) : floor(lf);
+        r.v.i = li - ri * (li / ri);
+        result = 1;
+      }
+      break;
+    case OPLOG_MDL:
+      if (rf != 0) {
+        r.type = V_NUM;
+        r.v.n = fmod(lf, rf) + rf * (SGN(lf) != SGN(rf));
+        result = 1;
+      }
+      break;
+    default:
+      break;
+    }
+    break;
+  case kwTYPE_POWOPR:
+    r.type = V_NUM;
+    r.v.n = pow(lf, rf);
+    result = 1;
+    break;
+  default:
+    break;
+  }
+
+  if (result && r.type == V_NUM && !isfinite(r.v.n)) {
+    // leave it to the run-time to report
+    result = 0;
+  }
+  if (result) {
+    cev_set_const(start, &r);
+  }
+  return result;
+}
+
+/*
+ * folds a unary operator applied to a numeric constant
+ */
+int cev_fold_unary(bcip_t start, code_t op) {
+  var_t v;
+  int result = 0;
+
+  v_init(&v);
+  if (cev_get_const(start, bc_out->count, &v) && v.type != V_STR) {
+    result = 1;
+    switch (op) {
+    case '-':
+      if (v.type == V_INT) {
+        v.v.i = -v.v.i;
+      } else {
+        v.v.n = -v.v.n;
+      }
+      break;
+    case '+':
+      break;
+    case OPLOG_INV:
+      v.v.i = ~v_igetval(&v);
+      v.type = V_INT;
+      break;
+    case OPLOG_NOT:
+      v.v.i = !v_igetval(&v);
+      v.type = V_INT;
+      break;
+    default:
+      result = 0;
+      break;
+    }
+    if (result) {
+      cev_set_const(start, &v);
+    }
+  }
+  v_free(&v);
+  return result;
+}
+
+/*
+ * folds a call to a pure built-in function with a constant argument
+ */
+void cev_fold_callf(bcip_t start) {
+  bcip_t args = start + 1 + ADDRSZ;
+  bcip_t fcode;
+  var_t arg, r;
+
+  if (bc_out->count < args + 2 ||
+      bc_out->ptr[args] != kwTYPE_LEVEL_BEGIN ||
+      bc_out->ptr[bc_out->count - 1] != kwTYPE_LEVEL_END) {
+    return;
+  }
+
+  v_init(&arg);
+  if (!cev_get_const(args + 1, bc_out->count - 1, &arg)) {
+    return;
+  }
+
+  v_init(&r);
+  int fold = 1;
+  memcpy(&fcode, bc_out->ptr + start + 1, ADDRSZ);
+  switch (fcode) {
+  case kwCOS:
+  case kwSIN:
+  case kwTAN:
+  case kwCOSH:
+  case kwSINH:
+  case kwTANH:
+  case kwACOS:
+  case kwASIN:
+  case kwATAN:
+  case kwACOSH:
+  case kwASINH:
+  case kwATANH:
+  case kwSEC:
+  case kwSECH:
+  case kwASEC:
+  case kwASECH:
+  case kwCSC:
+  case kwCSCH:
+  case kwACSC:
+  case kwACSCH:
+  case kwCOT:
+  case kwCOTH:
+  case kwACOT:
+  case kwACOTH:
+  case kwSQR:
+  case kwABS:
+  case kwEXP:
+  case kwLOG:
+  case kwLOG10:
+  case kwFIX:
+  case kwINT:
+  case kwDEG:
+  case kwRAD:
+  case kwFLOOR:
+  case kwCEIL:
+  case kwFRAC:
+    if (arg.type == V_STR) {
+      fold = 0;
+    } else {
+      r.type = V_NUM;
+      r.v.n = cmd_math1(fcode, &arg);
+    }
+    break;
+  case kwLEN:
+    r.v.i = v_length(&arg);
+    break;
+  case kwASC:
+    if (arg.type == V_STR) {
+      cmd_ns1(fcode, &arg, &r);
+    } else {
+      fold = 0;
+    }
+    break;
+  case kwCHR:
+    // CHR(0) is not representable as a string constant
+    if (arg.type != V_STR && (v_getint(&arg) & 0xFF) != 0) {
+      r.type = V_STR;
+      r.v.p.ptr = NULL;
+      r.v.p.owner = 1;
+      cmd_str1(fcode, &arg, &r);
+    } else {
+      fold = 0;
+    }
+    break;
+  default:
+    fold = 0;
+    break;
+  }
+
+  if (fold && r.type == V_NUM && !isfinite(r.v.n)) {
+    fold = 0;
+  }
+  if (fold && !comp_error) {
+    cev_set_const(start, &r);
+  }
+  v_free(&arg);
+  v_free(&r);
+}
+
 void cev_prim_str() {
   uint32_t len;
   memcpy(&len, bc_in->ptr + bc_in->cp, OS_STRLEN);
@@ -161,6 +460,7 @@ void cev_check_dup_prim() {
  */
 void cev_prim() {
   IF_ERR_RTN;
+  bcip_t start = bc_out->count;
   byte code = CODE(IP);
   IP++;
   cev_add1(code);
@@ -209,6 +509,9 @@ void cev_prim() {
         cev_prim_args();
       }
     }
+    if (code == kwTYPE_CALLF) {
+      cev_fold_callf(start);
+    }
     if (code != kwBYREF) {
       cev_check_dup_prim();
     }
@@ -245,8 +548,9 @@ void cev_unary() {
   } else {
     op = 0;
   }
+  bcip_t start = bc_out->count;
   cev_parenth();        // R = cev_parenth
-  if (op) {
+  if (op && !comp_error && !cev_fold_unary(start, op)) {
     cev_add1(kwTYPE_UNROPR);
     cev_add1(op);       // R = op R
   }
@@ -256,17 +560,21 @@ void cev_unary() {
  * pow
  */
 void cev_pow() {
+  bcip_t start = bc_out->count;
   cev_unary();                  // R = cev_unary
 
   IF_ERR_RTN;
   while (CODE(IP) == kwTYPE_POWOPR) {
     IP += 2;
 
+    bcip_t push = bc_out->count;
     cev_add1(kwTYPE_EVPUSH);    // PUSH R
     cev_unary();                // R = cev_unary
     IF_ERR_RTN;
-    cev_add1(kwTYPE_EVPOP);     // POP LEFT
-    cev_add2(kwTYPE_POWOPR, '^'); // R = LEFT op R
+    if (!cev_fold_binary(start, push, kwTYPE_POWOPR, '^')) {
+      cev_add1(kwTYPE_EVPOP);     // POP LEFT
+      cev_add2(kwTYPE_POWOPR, '^'); // R = LEFT op R
+    }
   }
 }
 
@@ -274,6 +582,7 @@ void cev_pow() {
  * mul | div | mod
  */
 void cev_mul() {
+  bcip_t start = bc_out->count;
   cev_pow();                    // R = cev_pow()
 
   IF_ERR_RTN;
@@ -282,12 +591,15 @@ void cev_mul() {
 
     op = CODE(++IP);
     IP++;
+    bcip_t push = bc_out->count;
     cev_add1(kwTYPE_EVPUSH);    // PUSH R
 
     cev_pow();
     IF_ERR_RTN;
-    cev_add1(kwTYPE_EVPOP);      // POP LEFT
-    cev_add2(kwTYPE_MULOPR, op); // R = LEFT op R
+    if (!cev_fold_binary(start, push, kwTYPE_MULOPR, op)) {
+      cev_add1(kwTYPE_EVPOP);      // POP LEFT
+      cev_add2(kwTYPE_MULOPR, op); // R = LEFT op R
+    }
   }
 }
 
@@ -295,6 +607,7 @@ void cev_mul() {
  * add | sub
  */
 void cev_add() {
+  bcip_t start = bc_out->count;
   cev_mul();                    // R = cev_mul()
 
   IF_ERR_RTN;
@@ -304,13 +617,16 @@ void cev_add() {
     IP++;
     op = CODE(IP);
     IP++;
+    bcip_t push = bc_out->count;
     cev_add1(kwTYPE_EVPUSH);    // PUSH R
 
     cev_mul();                  // R = cev_mul
     IF_ERR_RTN;
 
-    cev_add1(kwTYPE_EVPOP);    // POP LEFT
-    cev_add2(kwTYPE_ADDOPR, op); // R = LEFT op R
+    if (!cev_fold_binary(start, push, kwTYPE_ADDOPR, op)) {
+      cev_add1(kwTYPE_EVPOP);    // POP LEFT
+      cev_add2(kwTYPE_ADDOPR, op); // R = LEFT op R
+    }
   }
 }
 
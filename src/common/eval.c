@@ -59,10 +59,15 @@ var_num_t *mat_toc(var_t *v, int32_t *rows, int32_t *cols) {
   }
 
   m = (var_num_t *)malloc(((*rows) * (*cols)) * sizeof(var_num_t));
+  if (v->pack_type == V_PACK_NUM) {
+    memcpy(m, v_ndata(v), (*rows) * (*cols) * sizeof(var_num_t));
+    return m;
+  }
   for (int i = 0; i < *rows; i++) {
     for (int j = 0; j < *cols; j++) {
       int pos = i * (*cols) + j;
-      var_t *e = v_elem(v, pos);
+      var_t tmp;
+      var_t *e = v_array_get(v, pos, &tmp);
       m[pos] = v_getval(e);
     }
   }
@@ -74,11 +79,18 @@ var_num_t *mat_toc(var_t *v, int32_t *rows, int32_t *cols) {
 // matrix: conv. double[nr][nc] to var_t
 //
 void mat_tov(var_t *v, var_num_t *m, int rows, int cols, int protect_col1) {
+  int packed = (v->type == V_ARRAY && v_is_packed(v));
   if (cols > 1 || protect_col1) {
     v_tomatrix(v, rows, cols);
   } else {
     v_toarray1(v, rows);
   }
+  if (packed && rows * cols > 0) {
+    // keep a packed result packed
+    v_array_pack(v, V_PACK_NUM);
+    memcpy(v_ndata(v), m, rows * cols * sizeof(var_num_t));
+    return;
+  }
   for (int i = 0; i < rows; i++) {
     for (int j = 0; j < cols; j++) {
       int pos = i * cols + j;
@@ -195,11 +207,18 @@ void mat_sub(var_t *l, var_t *r) {
 //
 void mat_mul_1d(var_t *l, var_t *r) {
   uint32_t size = v_asize(l);
+  if (v_is_packed(r)) {
+    v_array_pack(r, V_PACK_NUM);
+  }
   for (uint32_t i = 0; i < size; i++) {
-    var_t *elem = v_elem(r, i);
-    var_num_t v1 = v_getval(v_elem(l, i));
-    var_num_t v2 = v_getval(elem);
-    v_setreal(elem, (v1 * v2));
+    var_t tmp_l, tmp_r;
+    var_num_t v1 = v_getval(v_array_get(l, i, &tmp_l));
+    var_num_t v2 = v_getval(v_array_get(r, i, &tmp_r));
+    if (v_is_packed(r)) {
+      v_ndata(r)[i] = v1 * v2;
+    } else {
+      v_setreal(v_elem(r, i), (v1 * v2));
+    }
   }
 }
 
@@ -210,8 +229,9 @@ void mat_dot(var_t *l, var_t *r) {
   var_num_t result = 0;
   uint32_t size = v_asize(l);
   for (uint32_t i = 0; i < size; i++) {
-    var_num_t v1 = v_getval(v_elem(l, i));
-    var_num_t v2 = v_getval(v_elem(r, i));
+    var_t tmp_l, tmp_r;
+    var_num_t v1 = v_getval(v_array_get(l, i, &tmp_l));
+    var_num_t v2 = v_getval(v_array_get(r, i, &tmp_r));
     result += (v1 * v2);
   }
   v_setreal(r, result);
@@ -277,22 +297,24 @@ int v_wc_match(var_t *vwc, var_t *v) {
     int i;
     ri = 1;
     for (i = 0; i < v_asize(v); i++) {
-      var_t *elem_p = v_elem(v, i);
+      var_t tmp;
+      var_t *elem_p = v_array_get(v, i, &tmp);
       if (v_wc_match(vwc, elem_p) == 0) {
         ri = 0;
         break;
       }
     }
   } else if (v->type == V_STR) {
-    ri = wc_match(vwc->v.p.ptr, v->v.p.ptr);
+    ri = wc_match(v_strptr(vwc), v_strptr(v));
   } else if (v->type == V_NUM || v->type == V_INT) {
-    var_t *vt = v_clone(v);
-    v_tostr(vt);
+    var_t vt;
+    v_init(&vt);
+    v_set(&vt, v);
+    v_tostr(&vt);
     if (!prog_error) {
-      ri = wc_match(vwc->v.p.ptr, vt->v.p.ptr);
+      ri = wc_match(v_strptr(vwc), v_strptr(&vt));
     }
-    V_FREE(vt);
-    v_detach(vt);
+    v_free(&vt);
   }
   return ri;
 }
@@ -396,7 +418,8 @@ static inline void oper_mul(var_t *r, var_t *left) {
         }
       } else {
         rf = v_getval(r);
-        v_set(r, left);
+        v_move(r, left);
+        v_init(left);
         if (op == '*') {
           mat_mulN(r, rf);
         } else {
@@ -635,7 +658,8 @@ static inline void oper_cmp(var_t *r, var_t *left) {
     if (r->type == V_ARRAY) {
       int i;
       for (i = 0; i < v_asize(r); i++) {
-        var_t *elem_p = v_elem(r, i);
+        var_t tmp;
+        var_t *elem_p = v_array_get(r, i, &tmp);
         if (v_compare(left, elem_p) == 0) {
           ri = i + 1;
           break;
@@ -643,17 +667,18 @@ static inline void oper_cmp(var_t *r, var_t *left) {
       }
     } else if (r->type == V_STR) {
       if (v_is_type(left, V_STR)) {
-        if (left->v.p.ptr[0] != '\0') {
-          ri = (strstr(r->v.p.ptr, left->v.p.ptr) != NULL);
+        if (v_strptr(left)[0] != '\0') {
+          ri = (strstr(v_strptr(r), v_strptr(left)) != NULL);
         } else {
           ri = 0;
         }
       } else if (v_is_type(left, V_NUM) || v_is_type(left, V_INT)) {
-        var_t *v = v_clone(left);
-        v_tostr(v);
-        ri = (strstr(r->v.p.ptr, v->v.p.ptr) != NULL);
-        V_FREE(v);
-        v_detach(v);
+        var_t v;
+        v_init(&v);
+        v_set(&v, left);
+        v_tostr(&v);
+        ri = (strstr(v_strptr(r), v_strptr(&v)) != NULL);
+        v_free(&v);
       }
     } else if (r->type == V_NUM || r->type == V_INT) {
       ri = (v_compare(left, r) == 0);
@@ -795,29 +820,119 @@ static inline void eval_var(var_t *r, var_t *var_p) {
   }
 }
 
-static inline void eval_push(var_t *r) {
-  bcip_t len;
+/**
+ * reads an element of an array without copying shared storage. returns 0 when
+ * the variable is not an array followed by an index
+ */
+static inline int eval_array_elem(var_t *r) {
+  var_t *array = code_getarray();
+  if (array == NULL) {
+    return 0;
+  }
+
+  var_t tmp;
+  var_t *var_p = code_getvarptr_read(array, &tmp);
+  if (var_p != NULL) {
+    eval_var(r, var_p);
+  }
+  return 1;
+}
 
-  switch (r->type) {
+/**
+ * reads a field of a map without copying a shared table. returns 0 when the
+ * variable is not a map followed by fields which hold plain values, leaving
+ * the IP for the generic path, which may add a missing field or call a method
+ */
+static inline int eval_map_field(var_t *r) {
+  if (CODE_PEEK() != kwTYPE_VAR || CODE(IP + 1 + ADDRSZ) != kwTYPE_UDS_EL) {
+    return 0;
+  }
+  var_t *map = tvar[code_peekaddr(IP + 1)];
+  if (map->type != V_MAP) {
+    return 0;
+  }
+
+  bcip_t ip = IP;
+  IP += 1 + ADDRSZ;
+  var_t *var_p = map_read_fields(map);
+  if (var_p == NULL || CODE_PEEK() == kwTYPE_LEVEL_BEGIN) {
+    IP = ip;
+    return 0;
+  }
+  switch (var_p->type) {
   case V_INT:
-    eval_stk[eval_sp].type = V_INT;
-    eval_stk[eval_sp].v.i = r->v.i;
-    break;
   case V_NUM:
-    eval_stk[eval_sp].type = V_NUM;
-    eval_stk[eval_sp].v.n = r->v.n;
-    break;
   case V_STR:
-    len = r->v.p.length;
-    eval_stk[eval_sp].type = V_STR;
-    eval_stk[eval_sp].v.p.ptr = malloc(len + 1);
-    eval_stk[eval_sp].v.p.owner = 1;
-    strcpy(eval_stk[eval_sp].v.p.ptr, r->v.p.ptr);
-    eval_stk[eval_sp].v.p.length = len;
-    break;
+  case V_ARRAY:
+  case V_MAP:
+  case V_NIL:
+    eval_var(r, var_p);
+    return 1;
   default:
-    v_set(&eval_stk[eval_sp], r);
+    IP = ip;
+    return 0;
   }
+}
+
+/**
+ * kwTYPE_VAR_OPR_INT superinstruction from comp_optimise(). returns 0
+ * when the variable is not a plain number so the caller can continue
+ * with the kwTYPE_VAR sequence that follows
+ */
+static inline int eval_var_opr_int(var_t *r) {
+  var_t *var_p = tvar[code_peekaddr(IP + 1)];
+  if (var_p->type != V_INT && var_p->type != V_NUM) {
+    return 0;
+  }
+
+  var_int_t k;
+  memcpy(&k, prog_source + IP + BC_VAR_OPR_INT_K, OS_INTSZ);
+  byte op = CODE(IP + BC_VAR_OPR_INT_OPR + 1);
+
+  V_FREE(r);
+  if (CODE(IP + BC_VAR_OPR_INT_OPR) == kwTYPE_ADDOPR) {
+    if (var_p->type == V_INT) {
+      r->type = V_INT;
+      r->v.i = (op == '+') ? var_p->v.i + k : var_p->v.i - k;
+    } else {
+      r->type = V_NUM;
+      r->v.n = (op == '+') ? var_p->v.n + k : var_p->v.n - k;
+    }
+  } else {
+    var_t right;
+    v_init(&right);
+    right.v.i = k;
+    int cmp = v_compare(var_p, &right);
+    switch (op) {
+    case OPLOG_EQ:
+      r->v.i = (cmp == 0);
+      break;
+    case OPLOG_GT:
+      r->v.i = (cmp > 0);
+      break;
+    case OPLOG_GE:
+      r->v.i = (cmp >= 0);
+      break;
+    case OPLOG_LT:
+      r->v.i = (cmp < 0);
+      break;
+    case OPLOG_LE:
+      r->v.i = (cmp <= 0);
+      break;
+    default:
+      r->v.i = (cmp != 0);
+      break;
+    }
+    r->type = V_INT;
+  }
+  IP += BC_VAR_OPR_INT_LEN;
+  return 1;
+}
+
+static inline void eval_push(var_t *r) {
+  // the stack takes over the value, r is then assigned the next operand
+  eval_stk[eval_sp] = *r;
+  v_init(r);
 
   // expression-stack resize
   eval_sp++;
@@ -1236,55 +1351,112 @@ static inline void eval_callf(var_t *r) {
 }
 
 //
-// executes the expression (Code[IP]) and returns the result (r)
+// executes the expression (Code[IP]) and returns the result (r). an operand
+// ends at a kwTYPE_EVPOP without a matching kwTYPE_EVPUSH
 //
-void eval(var_t *r) {
+// when built with USE_COMPUTED_GOTO each handler jumps directly to the
+// next handler through eval_dispatch[] instead of returning to the switch
+//
+#if defined(USE_COMPUTED_GOTO)
+#define EVAL_TARGET(c)  case c: eval_##c
+#define EVAL_SWITCH(c)  goto *eval_dispatch[c]; switch (c)
+#define EVAL_NEXT()     if (!prog_error) goto *eval_dispatch[CODE_PEEK()]; break
+#else
+#define EVAL_TARGET(c)  case c
+#define EVAL_SWITCH(c)  switch (c)
+#define EVAL_NEXT()     break
+#endif
+
+static void eval_expr(var_t *r, int operand) {
   var_t *left = NULL;
   bcip_t eval_pos = eval_sp;
   byte level = 0;
+  byte code;
+
+#if defined(USE_COMPUTED_GOTO)
+  static const void *const eval_dispatch[256] = {
+    [0 ... 255] = &&eval_default,
+    [kwTYPE_INT] = &&eval_kwTYPE_INT,
+    [kwTYPE_NUM] = &&eval_kwTYPE_NUM,
+    [kwTYPE_ADDOPR] = &&eval_kwTYPE_ADDOPR,
+    [kwTYPE_MULOPR] = &&eval_kwTYPE_MULOPR,
+    [kwTYPE_VAR] = &&eval_kwTYPE_VAR,
+    [kwTYPE_VAR_OPR_INT] = &&eval_kwTYPE_VAR_OPR_INT,
+    [kwTYPE_LEVEL_BEGIN] = &&eval_kwTYPE_LEVEL_BEGIN,
+    [kwTYPE_LEVEL_END] = &&eval_kwTYPE_LEVEL_END,
+    [kwTYPE_EVPUSH] = &&eval_kwTYPE_EVPUSH,
+    [kwTYPE_EVPOP] = &&eval_kwTYPE_EVPOP,
+    [kwTYPE_CALLF] = &&eval_kwTYPE_CALLF,
+    [kwTYPE_STR] = &&eval_kwTYPE_STR,
+    [kwTYPE_LOGOPR] = &&eval_kwTYPE_LOGOPR,
+    [kwTYPE_CMPOPR] = &&eval_kwTYPE_CMPOPR,
+    [kwTYPE_POWOPR] = &&eval_kwTYPE_POWOPR,
+    [kwTYPE_UNROPR] = &&eval_kwTYPE_UNROPR,
+    [kwTYPE_EVAL_SC] = &&eval_kwTYPE_EVAL_SC,
+    [kwTYPE_CALL_UDF] = &&eval_kwTYPE_CALL_UDF,
+    [kwTYPE_CALLEXTF] = &&eval_kwTYPE_CALLEXTF,
+    [kwTYPE_PTR] = &&eval_kwTYPE_PTR,
+    [kwBYREF] = &&eval_kwBYREF
+  };
+#endif
 
   while (!prog_error) {
-    byte code = prog_source[prog_ip];
-    switch (code) {
-    case kwTYPE_INT:
+    code = prog_source[prog_ip];
+    EVAL_SWITCH(code) {
+    EVAL_TARGET(kwTYPE_INT):
       // integer - constant
       IP++;
       V_FREE(r);
       r->type = V_INT;
       r->v.i = code_getint();
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_NUM:
+    EVAL_TARGET(kwTYPE_NUM):
       // double - constant
       IP++;
       V_FREE(r);
       r->type = V_NUM;
       r->v.n = code_getreal();
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_ADDOPR:
+    EVAL_TARGET(kwTYPE_ADDOPR):
       IP++;
       oper_add(r, left);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_MULOPR:
+    EVAL_TARGET(kwTYPE_MULOPR):
       IP++;
       oper_mul(r, left);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_VAR:
+    EVAL_TARGET(kwTYPE_VAR):
       // variable
       V_FREE(r);
-      eval_var(r, code_getvarptr());
-      break;
+      if (!eval_array_elem(r) && !eval_map_field(r)) {
+        eval_var(r, code_getvarptr());
+      }
+      EVAL_NEXT();
 
-    case kwTYPE_LEVEL_BEGIN:
+    EVAL_TARGET(kwTYPE_VAR_OPR_INT):
+      // variable followed by +/- or compare with an integer
+      if (!eval_var_opr_int(r)) {
+        IP++;
+        var_t *var_p = tvar[code_getaddr()];
+        if (var_p->type == V_MAP) {
+          var_p = code_resolve_map(var_p, 0);
+        }
+        V_FREE(r);
+        eval_var(r, var_p);
+      }
+      EVAL_NEXT();
+
+    EVAL_TARGET(kwTYPE_LEVEL_BEGIN):
       // left parenthesis
       IP++;
       level++;
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_LEVEL_END:
+    EVAL_TARGET(kwTYPE_LEVEL_END):
       // right parenthesis
       if (level == 0) {
         eval_sp = eval_pos;
@@ -1293,15 +1465,19 @@ void eval(var_t *r) {
       }
       level--;
       IP++;
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_EVPUSH:
+    EVAL_TARGET(kwTYPE_EVPUSH):
       // stack = push result
       IP++;
       eval_push(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_EVPOP:
+    EVAL_TARGET(kwTYPE_EVPOP):
+      if (operand && eval_sp == eval_pos) {
+        // the end of the operand
+        return;
+      }
       // pop left
       IP++;
       if (!eval_sp) {
@@ -1310,69 +1486,73 @@ void eval(var_t *r) {
       }
       eval_sp--;
       left = &eval_stk[eval_sp];
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_CALLF:
+    EVAL_TARGET(kwTYPE_CALLF):
       // built-in functions
       IP++;
       eval_callf(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_STR:
+    EVAL_TARGET(kwTYPE_STR):
       // string - constant
       IP++;
       V_FREE(r);
       v_eval_str(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_LOGOPR:
+    EVAL_TARGET(kwTYPE_LOGOPR):
       IP++;
       oper_log(r, left);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_CMPOPR:
+    EVAL_TARGET(kwTYPE_CMPOPR):
       IP++;
       oper_cmp(r, left);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_POWOPR:
+    EVAL_TARGET(kwTYPE_POWOPR):
       IP++;
       oper_powr(r, left);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_UNROPR:
+    EVAL_TARGET(kwTYPE_UNROPR):
       // unary
       IP++;
       oper_unary(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_EVAL_SC:
+    EVAL_TARGET(kwTYPE_EVAL_SC):
       IP++;
       eval_shortc(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_CALL_UDF:
+    EVAL_TARGET(kwTYPE_CALL_UDF):
       eval_call_udf(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_CALLEXTF:
+    EVAL_TARGET(kwTYPE_CALLEXTF):
       // [lib][index] external functions
       IP++;
       eval_extf(r);
-      break;
+      EVAL_NEXT();
 
-    case kwTYPE_PTR:
+    EVAL_TARGET(kwTYPE_PTR):
       // UDF pointer - constant
       IP++;
       eval_ptr(r);
-      break;
+      EVAL_NEXT();
 
-    case kwBYREF:
+    EVAL_TARGET(kwBYREF):
       // unexpected code
       err_evsyntax();
       return;
 
-    default: {
+    default:
+#if defined(USE_COMPUTED_GOTO)
+    eval_default:
+      code = CODE_PEEK();
+#endif
       if (code == kwTYPE_LINE ||
           code == kwTYPE_SEP ||
           code == kwTO ||
@@ -1389,9 +1569,17 @@ void eval(var_t *r) {
       if (!opt_quiet) {
         hex_dump(prog_source, prog_length);
       }
-    }};
+    };
   }
 
   // restore stack pointer
   eval_sp = eval_pos;
 }
+
+void eval(var_t *r) {
+  eval_expr(r, 0);
+}
+
+void eval_operand(var_t *r) {
+  eval_expr(r, 1);
+}
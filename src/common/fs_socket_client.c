@@ -146,13 +146,13 @@ int http_read(dev_file_t *f, var_t *var_p) {
         var_p->v.p.length = bytes;
         var_p->v.p.ptr = malloc(var_p->v.p.length + 1);
         var_p->v.p.owner = 1;
-        memcpy(var_p->v.p.ptr, rxbuff, var_p->v.p.length);
-        var_p->v.p.ptr[var_p->v.p.length] = '\0';
+        memcpy(v_strptr(var_p), rxbuff, var_p->v.p.length);
+        v_strptr(var_p)[var_p->v.p.length] = '\0';
       } else {
         var_p->v.p.ptr = realloc(var_p->v.p.ptr, var_p->v.p.length + bytes + 1);
-        memcpy(var_p->v.p.ptr + var_p->v.p.length, rxbuff, bytes);
+        memcpy(v_strptr(var_p) + var_p->v.p.length, rxbuff, bytes);
         var_p->v.p.length += bytes;
-        var_p->v.p.ptr[var_p->v.p.length] = '\0';
+        v_strptr(var_p)[var_p->v.p.length] = '\0';
       }
     } else {
       int i = 0;
@@ -175,8 +175,8 @@ int http_read(dev_file_t *f, var_t *var_p) {
           var_p->v.p.length = bytes - i;
           var_p->v.p.ptr = malloc(var_p->v.p.length + 1);
           var_p->v.p.owner = 1;
-          memcpy(var_p->v.p.ptr, rxbuff + i, var_p->v.p.length);
-          var_p->v.p.ptr[var_p->v.p.length] = '\0';
+          memcpy(v_strptr(var_p), rxbuff + i, var_p->v.p.length);
+          v_strptr(var_p)[var_p->v.p.length] = '\0';
         }
         inContent = 1;
       }
@@ -14,108 +14,200 @@
 #include "common/smbas.h"
 #include "common/hashmap.h"
 
-#define MAP_SIZE 32
+// the smallest number of slots
+#define MAP_SLOTS 8
+
+// the smallest number of entries in the first chunk
+#define MAP_CHUNK 4
+
+// the number of entries allowed before the slots are doubled
+#define MAP_LOAD(slots) (((slots) * 3) / 4)
+
+// the identity given to the next table, see hashmap_stamp()
+static uintptr_t next_stamp = 1;
 
 /**
- * Our internal tree element node
+ * returns the key length without any trailing terminator
  */
-typedef struct Node {
-  var_p_t key;
-  var_p_t value;
-  struct Node *left, *right;
-} Node;
+static inline int hashmap_key_len(const char *key, int length) {
+  if (length && key[length - 1] == '\0') {
+    length--;
+  }
+  return length;
+}
 
 /**
- * Returns a new tree node
+ * case insensitive FNV-1a, mixed so the low bits used to select the slot
+ * depend on every character
  */
-Node *tree_create_node(var_p_t key) {
-  Node *node = (Node *)malloc(sizeof(Node));
-  node->key = key;
-  node->value = NULL;
-  node->left = NULL;
-  node->right = NULL;
-  return node;
+static inline uint32_t hashmap_get_hash(const char *key, int length) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < length; i++) {
+    hash ^= (uint8_t)to_lower(key[i]);
+    hash *= 16777619u;
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+static inline int hashmap_key_equals(const hashmap_entry_t *entry, const char *key, int length) {
+  const char *text = v_strptr(&entry->key);
+  int len = hashmap_key_len(text, entry->key.v.p.length);
+  return len == length && strcaselessn(key, length, text, len) == 0;
 }
 
 /**
- * cleanup the given element
+ * returns the first chunk, which follows the table
  */
-void tree_delete_node(Node *node) {
-  // cleanup v_new
-  v_free(node->key);
-  v_detach(node->key);
-
-  // cleanup v_new
-  if (node->value) {
-    v_free(node->value);
-    v_detach(node->value);
-  }
+static inline hashmap_entry_t *hashmap_first_chunk(hashmap_table_t *table) {
+  return (hashmap_entry_t *)(table + 1);
+}
 
-  // cleanup the node
-  free(node);
+/**
+ * returns the number of entries held in the given chunk
+ */
+static inline uint32_t hashmap_chunk_size(const hashmap_table_t *table, uint32_t n) {
+  return n == 0 ? table->first : table->first << (n - 1);
 }
 
-static inline int tree_compare(const char *key, int length, var_p_t vkey) {
-  int len1 = length;
-  if (len1 && key[len1 - 1] == '\0') {
-    len1--;
+/**
+ * returns a new table with room for the given number of entries. the first
+ * chunk and the initial slots are part of the same allocation
+ */
+static hashmap_table_t *hashmap_new_table(uint32_t entries) {
+  uint32_t slots = MAP_SLOTS;
+  if (entries < MAP_CHUNK) {
+    entries = MAP_CHUNK;
   }
-  int len2 = vkey->v.p.length;
-  if (len2 && vkey->v.p.ptr[len2 - 1] == '\0') {
-    len2--;
+  while (MAP_LOAD(slots) < entries) {
+    slots <<= 1;
   }
-  return strcaselessn(key, len1, vkey->v.p.ptr, len2);
+  hashmap_table_t *table = (hashmap_table_t *)
+    v_shared_new(sizeof(hashmap_table_t) +
+                 (entries * sizeof(hashmap_entry_t)) +
+                 (slots * sizeof(hashmap_slot_t)));
+  table->stamp = next_stamp++;
+  table->slots = (hashmap_slot_t *)(hashmap_first_chunk(table) + entries);
+  table->chunks = NULL;
+  table->count = 0;
+  table->mask = slots - 1;
+  table->first = entries;
+  table->capacity = entries;
+  table->nchunks = 0;
+  v_shared_hdr(table)->size = slots;
+  return table;
 }
 
-void tree_destroy(Node *node) {
-  if (node->left != NULL) {
-    tree_destroy(node->left);
+static void hashmap_free_table(hashmap_table_t *table) {
+  uint32_t index = 0;
+  for (uint32_t n = 0; n <= table->nchunks && index < table->count; n++) {
+    hashmap_entry_t *chunk = n == 0 ? hashmap_first_chunk(table) : table->chunks[n - 1];
+    uint32_t size = hashmap_chunk_size(table, n);
+    for (uint32_t i = 0; i < size && index < table->count; i++, index++) {
+      v_free(&chunk[i].key);
+      v_free(&chunk[i].value);
+    }
+  }
+  for (uint32_t n = 0; n < table->nchunks; n++) {
+    free(table->chunks[n]);
   }
-  if (node->right != NULL) {
-    tree_destroy(node->right);
+  free(table->chunks);
+  if (table->slots != (hashmap_slot_t *)(hashmap_first_chunk(table) + table->first)) {
+    free(table->slots);
   }
-  tree_delete_node(node);
+  v_shared_free(table);
 }
 
-Node *tree_search(Node **rootp, const char *key, int length) {
-  while (*rootp != NULL) {
-    int r = tree_compare(key, length, (*rootp)->key);
-    if (r == 0) {
-      return *rootp;
+/**
+ * robin hood insertion: an entry further from its home slot takes the place
+ * of one that is nearer to its own
+ */
+static void hashmap_insert_slot(hashmap_slot_t *slots, uint32_t mask,
+                                hashmap_entry_t *entry, uint32_t hash) {
+  uint32_t pos = hash & mask;
+  uint32_t dist = 0;
+  while (slots[pos].entry != NULL) {
+    uint32_t slot_dist = (pos - slots[pos].hash) & mask;
+    if (slot_dist < dist) {
+      hashmap_entry_t *next_entry = slots[pos].entry;
+      uint32_t next_hash = slots[pos].hash;
+      slots[pos].entry = entry;
+      slots[pos].hash = hash;
+      entry = next_entry;
+      hash = next_hash;
+      dist = slot_dist;
     }
-    rootp = (r < 0) ? &(*rootp)->left : &(*rootp)->right;
+    pos = (pos + 1) & mask;
+    dist++;
   }
-  Node *result = tree_create_node(NULL);
-  *rootp = result;
-  return result;
+  slots[pos].entry = entry;
+  slots[pos].hash = hash;
 }
 
-Node *tree_find(Node **rootp, const char *key, int length) {
-  while (*rootp != NULL) {
-    int r = tree_compare(key, length, (*rootp)->key);
-    if (r == 0) {
-      return *rootp;
+/**
+ * doubles the number of slots, the entries remain in place
+ */
+static void hashmap_grow(hashmap_table_t *table) {
+  uint32_t size = (table->mask + 1) * 2;
+  hashmap_slot_t *slots = (hashmap_slot_t *)calloc(size, sizeof(hashmap_slot_t));
+  for (uint32_t i = 0; i <= table->mask; i++) {
+    if (table->slots[i].entry != NULL) {
+      hashmap_insert_slot(slots, size - 1, table->slots[i].entry, table->slots[i].hash);
     }
-    rootp = (r < 0) ? &(*rootp)->left : &(*rootp)->right;
   }
-  return NULL;
+  if (table->slots != (hashmap_slot_t *)(hashmap_first_chunk(table) + table->first)) {
+    free(table->slots);
+  }
+  table->slots = slots;
+  table->mask = size - 1;
+  v_shared_hdr(table)->size = size;
 }
 
-int tree_foreach(const Node *nodep, hashmap_foreach_func func, hashmap_cb *data) {
-  if (nodep != NULL) {
-    if (nodep->left != NULL && !tree_foreach(nodep->left, func, data)) {
-      return 0;
+static hashmap_entry_t *hashmap_find_entry(const hashmap_table_t *table, const char *key,
+                                           int length, uint32_t hash) {
+  uint32_t pos = hash & table->mask;
+  for (uint32_t dist = 0;; dist++) {
+    const hashmap_slot_t *slot = &table->slots[pos];
+    if (slot->entry == NULL || ((pos - slot->hash) & table->mask) < dist) {
+      // the key would have displaced this entry
+      return NULL;
     }
-
-    if (func(data, nodep->key, nodep->value)) {
-      return 0;
+    if (slot->hash == hash && hashmap_key_equals(slot->entry, key, length)) {
+      return slot->entry;
     }
+    pos = (pos + 1) & table->mask;
+  }
+}
 
-    if (nodep->right != NULL && !tree_foreach(nodep->right, func, data)) {
-      return 0;
-    }
+/**
+ * appends an empty entry to the map's table
+ */
+static hashmap_entry_t *hashmap_add_entry(var_p_t map, uint32_t hash) {
+  hashmap_table_t *table = (hashmap_table_t *)map->v.m.map;
+  if (table->count == table->capacity) {
+    // the new chunk doubles the capacity
+    uint32_t size = table->capacity;
+    table->chunks = (hashmap_entry_t **)realloc(table->chunks, (table->nchunks + 1) * sizeof(hashmap_entry_t *));
+    table->chunks[table->nchunks++] = (hashmap_entry_t *)malloc(size * sizeof(hashmap_entry_t));
+    table->capacity += size;
   }
-  return 1;
+  if (table->count + 1 > MAP_LOAD(table->mask + 1)) {
+    hashmap_grow(table);
+  }
+
+  uint32_t size = hashmap_chunk_size(table, table->nchunks);
+  hashmap_entry_t *chunk = table->nchunks == 0 ? hashmap_first_chunk(table) : table->chunks[table->nchunks - 1];
+  hashmap_entry_t *result = &chunk[table->count - (table->capacity - size)];
+  v_init(&result->key);
+  v_init(&result->value);
+  hashmap_insert_slot(table->slots, table->mask, result, hash);
+
+  table->count++;
+  map->v.m.count = table->count;
+  map->v.m.size = table->mask + 1;
+  return result;
 }
 
 /**
@@ -128,137 +220,182 @@ void hashmap_create(var_p_t map, int size) {
   map->v.m.id = -1;
   map->v.m.lib_id = -1;
   map->v.m.cls_id = -1;
-  if (size == 0) {
-    map->v.m.size = MAP_SIZE;
-  } else {
-    map->v.m.size = (size * 100) / 75;
-  }
-  map->v.m.map = calloc(map->v.m.size, sizeof(Node *));
+  hashmap_table_t *table = hashmap_new_table(size);
+  map->v.m.map = table;
+  map->v.m.size = table->mask + 1;
 }
 
 int hashmap_destroy(var_p_t var_p) {
   if (var_p->type == V_MAP && var_p->v.m.map != NULL) {
-    Node **table = (Node **)var_p->v.m.map;
-    for (int i = 0; i < var_p->v.m.size; i++) {
-      if (table[i] != NULL) {
-        tree_destroy(table[i]);
-      }
+    var_shared_t *hdr = v_shared_hdr(var_p->v.m.map);
+    if (hdr->refs > 1) {
+      // still in use by another variable
+      hdr->refs--;
+    } else {
+      hashmap_free_table((hashmap_table_t *)var_p->v.m.map);
     }
-    free(var_p->v.m.map);
   }
   return 0;
 }
 
-int hashmap_get_hash(const char *key, int length) {
-  int hash = 1, i;
-  for (i = 0; i < length && key[i] != '\0'; i++) {
-    hash += to_lower(key[i]);
-    hash <<= 3;
-    hash ^= (hash >> 3);
+/**
+ * makes dest share the table of src until either variable is modified
+ */
+void hashmap_share(var_p_t dest, const var_p_t src) {
+  v_free(dest);
+  dest->type = V_MAP;
+  dest->v.m.map = src->v.m.map;
+  dest->v.m.count = src->v.m.count;
+  dest->v.m.size = src->v.m.size;
+  dest->v.m.id = src->v.m.id;
+  dest->v.m.lib_id = -1;
+  dest->v.m.cls_id = -1;
+  if (dest->v.m.map != NULL) {
+    v_shared_hdr(dest->v.m.map)->refs++;
   }
-  return hash;
 }
 
-static inline Node *hashmap_search(var_p_t map, const char *key, int length) {
-  int index = hashmap_get_hash(key, length) % map->v.m.size;
-  Node **table = (Node **)map->v.m.map;
-  Node *result = table[index];
-  if (result == NULL) {
-    // new entry
-    result = table[index] = tree_create_node(NULL);
-  } else {
-    int r = tree_compare(key, length, result->key);
-    if (r < 0) {
-      result = tree_search(&result->left, key, length);
-    } else if (r > 0) {
-      result = tree_search(&result->right, key, length);
+/**
+ * gives the map its own copy of the shared table
+ */
+static void hashmap_clone(var_p_t map) {
+  hashmap_table_t *shared = (hashmap_table_t *)map->v.m.map;
+  map->v.m.map = hashmap_new_table(shared->count);
+  map->v.m.count = 0;
+
+  uint32_t index = 0;
+  for (uint32_t n = 0; n <= shared->nchunks && index < shared->count; n++) {
+    hashmap_entry_t *chunk = n == 0 ? hashmap_first_chunk(shared) : shared->chunks[n - 1];
+    uint32_t size = hashmap_chunk_size(shared, n);
+    for (uint32_t i = 0; i < size && index < shared->count; i++, index++) {
+      const var_p_t key = &chunk[i].key;
+      if (key->type != V_STR || v_strptr(key)[0] != MAP_TMP_FIELD[0]) {
+        int length = hashmap_key_len(v_strptr(key), key->v.p.length);
+        hashmap_entry_t *entry = hashmap_add_entry(map, hashmap_get_hash(v_strptr(key), length));
+        v_set(&entry->key, key);
+        v_set(&entry->value, &chunk[i].value);
+      }
     }
   }
-  return result;
+
+  // release the previous table
+  var_t prev;
+  v_init(&prev);
+  prev.type = V_MAP;
+  prev.v.m.map = shared;
+  hashmap_destroy(&prev);
 }
 
-static inline Node *hashmap_find(var_p_t map, const char *key) {
-  int length = strlen(key);
-  int index = hashmap_get_hash(key, length) % map->v.m.size;
-  Node **table = (Node **)map->v.m.map;
-  Node *result = table[index];
-  if (result != NULL) {
-    int r = tree_compare(key, length, result->key);
-    if (r < 0 && result->left != NULL) {
-      result = tree_find(&result->left, key, length);
-    } else if (r > 0 && result->right != NULL) {
-      result = tree_find(&result->right, key, length);
-    } else if (r != 0) {
-      result = NULL;
-    }
+void hashmap_unshare(var_p_t map) {
+  if (map->v.m.map != NULL && v_shared_hdr(map->v.m.map)->refs > 1) {
+    hashmap_clone(map);
   }
-  return result;
 }
 
 var_p_t hashmap_put(var_p_t map, const char *key, int length) {
-  Node *node = hashmap_search(map, key, length);
-  if (node->key == NULL) {
-    node->key = v_new();
-    node->value = v_new();
-    v_setstrn(node->key, key, length);
-    map->v.m.count++;
+  hashmap_unshare(map);
+  int len = hashmap_key_len(key, length);
+  uint32_t hash = hashmap_get_hash(key, len);
+  hashmap_entry_t *entry = hashmap_find_entry((hashmap_table_t *)map->v.m.map, key, len, hash);
+  if (entry == NULL) {
+    entry = hashmap_add_entry(map, hash);
+    v_setstrn(&entry->key, key, length);
   }
-  return node->value;
+  return &entry->value;
 }
 
 var_p_t hashmap_putc(var_p_t map, const char *key, int length) {
-  Node *node = hashmap_search(map, key, length);
-  if (node->key == NULL) {
-    var_t *var_key = v_new();
-    var_key->type = V_STR;
-    var_key->v.p.length = length;
-    var_key->v.p.ptr = (char *)key;
-    var_key->v.p.owner = 0;
-    node->key = var_key;
-    node->value = v_new();
-    map->v.m.count++;
+  hashmap_unshare(map);
+  int len = hashmap_key_len(key, length);
+  uint32_t hash = hashmap_get_hash(key, len);
+  hashmap_entry_t *entry = hashmap_find_entry((hashmap_table_t *)map->v.m.map, key, len, hash);
+  if (entry == NULL) {
+    entry = hashmap_add_entry(map, hash);
+    entry->key.type = V_STR;
+    entry->key.v.p.length = length;
+    entry->key.v.p.ptr = (char *)key;
+    entry->key.v.p.owner = V_STR_BORROWED;
   }
-  return node->value;
+  return &entry->value;
 }
 
 var_p_t hashmap_putv(var_p_t map, const var_p_t key) {
   // hashmap takes ownership of key
+  hashmap_unshare(map);
   if (key->type != V_STR) {
     // keys are always strings
     v_tostr(key);
   }
 
-  Node *node = hashmap_search(map, key->v.p.ptr, key->v.p.length);
-  if (node->key == NULL) {
-    node->key = key;
-    node->value = v_new();
-    map->v.m.count++;
+  int len = hashmap_key_len(v_strptr(key), key->v.p.length);
+  uint32_t hash = hashmap_get_hash(v_strptr(key), len);
+  hashmap_entry_t *entry = hashmap_find_entry((hashmap_table_t *)map->v.m.map, v_strptr(key), len, hash);
+  if (entry == NULL) {
+    entry = hashmap_add_entry(map, hash);
+    v_move(&entry->key, key);
   } else {
     // discard unused key
     v_free(key);
-    v_detach(key);
   }
-  return node->value;
+  v_detach(key);
+  return &entry->value;
 }
 
-var_p_t hashmap_get(var_p_t map, const char *key) {
-  var_p_t result;
-  Node *node = hashmap_find(map, key);
-  if (node != NULL) {
-    result = node->value;
-  } else {
-    result = NULL;
+/**
+ * returns the value for reading, a shared table is not copied
+ */
+var_p_t hashmap_get(const var_p_t map, const char *key) {
+  return hashmap_getc(map, key, strlen(key));
+}
+
+/**
+ * returns the value for reading, a shared table is not copied
+ */
+var_p_t hashmap_getc(const var_p_t map, const char *key, int length) {
+  hashmap_entry_t *entry = NULL;
+  if (map->v.m.map != NULL) {
+    int len = hashmap_key_len(key, length);
+    entry = hashmap_find_entry((hashmap_table_t *)map->v.m.map, key, len,
+                               hashmap_get_hash(key, len));
+  }
+  return entry != NULL ? &entry->value : NULL;
+}
+
+/**
+ * returns the key at the given position in the order the entries were added
+ */
+var_p_t hashmap_key_at(const var_p_t map, uint32_t index) {
+  var_p_t result = NULL;
+  hashmap_table_t *table = (hashmap_table_t *)map->v.m.map;
+  if (table != NULL && index < table->count) {
+    if (index < table->first) {
+      result = &hashmap_first_chunk(table)[index].key;
+    } else {
+      // chunk n starts at entry (first << (n - 1))
+      uint32_t n = 1;
+      uint32_t start = table->first;
+      while (index - start >= hashmap_chunk_size(table, n)) {
+        start += hashmap_chunk_size(table, n++);
+      }
+      result = &table->chunks[n - 1][index - start].key;
+    }
   }
   return result;
 }
 
+/**
+ * visits the entries in the order they were added
+ */
 void hashmap_foreach(var_p_t map, hashmap_foreach_func func, hashmap_cb *data) {
-  if (map && map->type == V_MAP) {
-    Node **table = (Node **)map->v.m.map;
-    for (int i = 0; i < map->v.m.size; i++) {
-      if (table[i] != NULL) {
-        if (!tree_foreach(table[i], func, data)) {
-          break;
+  if (map && map->type == V_MAP && map->v.m.map != NULL) {
+    hashmap_table_t *table = (hashmap_table_t *)map->v.m.map;
+    uint32_t index = 0;
+    for (uint32_t n = 0; n <= table->nchunks && index < table->count; n++) {
+      hashmap_entry_t *chunk = n == 0 ? hashmap_first_chunk(table) : table->chunks[n - 1];
+      uint32_t size = hashmap_chunk_size(table, n);
+      for (uint32_t i = 0; i < size && index < table->count; i++, index++) {
+        if (func(data, &chunk[i].key, &chunk[i].value)) {
+          return;
         }
       }
     }
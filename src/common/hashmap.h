@@ -24,15 +24,87 @@ typedef struct hashmap_cb {
   int start;
 } hashmap_cb;
 
+/**
+ * a key and its value, held in the order of insertion
+ */
+typedef struct hashmap_entry_s {
+  var_t key;
+  var_t value;
+} hashmap_entry_t;
+
+/**
+ * open addressing slot, empty when entry is NULL
+ */
+typedef struct hashmap_slot_s {
+  hashmap_entry_t *entry;
+  uint32_t hash;
+} hashmap_slot_t;
+
+/**
+ * the map table, held by var.v.m.map following a var_shared_t header. the
+ * entries are stored in chunks which are never moved, the first chunk follows
+ * the table, chunk n > 0 is chunks[n - 1] and holds (first << (n - 1)) entries
+ */
+typedef struct hashmap_table_s {
+  // identifies the table for hashmap_stamp()
+  uintptr_t stamp;
+
+  // mask + 1 slots, robin hood ordered
+  hashmap_slot_t *slots;
+
+  // the chunks after the first
+  hashmap_entry_t **chunks;
+
+  // the number of entries in use
+  uint32_t count;
+
+  // the number of slots - 1
+  uint32_t mask;
+
+  // the number of entries in the first chunk
+  uint32_t first;
+
+  // the number of entries held by all chunks
+  uint32_t capacity;
+
+  // the number of chunks after the first
+  uint32_t nchunks;
+} hashmap_table_t;
+
 typedef int (*hashmap_foreach_func)(hashmap_cb *cb, var_p_t k, var_p_t v);
 
 void hashmap_create(var_p_t map, int size);
 int  hashmap_destroy(var_p_t map);
+void hashmap_share(var_p_t dest, const var_p_t src);
+void hashmap_unshare(var_p_t map);
 var_p_t hashmap_put(var_p_t map, const char *key, int length);
 var_p_t hashmap_putc(var_p_t map, const char *key, int length);
 var_p_t hashmap_putv(var_p_t map, const var_p_t key);
-var_p_t hashmap_get(var_p_t map, const char *key);
+var_p_t hashmap_get(const var_p_t map, const char *key);
+var_p_t hashmap_getc(const var_p_t map, const char *key, int length);
+var_p_t hashmap_key_at(const var_p_t map, uint32_t index);
 void hashmap_foreach(var_p_t map, hashmap_foreach_func func, hashmap_cb *data);
 
-#endif /* !_HASHMAP_H_ */
+/**
+ * returns a value identifying the map's table while it can be updated in
+ * place, or 0 when the next update would first copy the table. each table
+ * has its own stamp and entries are never moved, so values found through a
+ * table with the same stamp are still in use
+ */
+static inline uintptr_t hashmap_stamp(const var_p_t map) {
+  uintptr_t result = 0;
+  if (map->v.m.map != NULL && v_shared_hdr(map->v.m.map)->refs == 1) {
+    result = ((const hashmap_table_t *)map->v.m.map)->stamp;
+  }
+  return result;
+}
 
+/**
+ * returns the value identifying the map's table, including while it is
+ * shared. values found through a table with the same stamp may be read
+ */
+static inline uintptr_t hashmap_read_stamp(const var_p_t map) {
+  return map->v.m.map != NULL ? ((const hashmap_table_t *)map->v.m.map)->stamp : 0;
+}
+
+#endif /* !_HASHMAP_H_ */
@@ -71,7 +71,7 @@ static inline var_num_t v_getval(var_t *v) {
   case V_NUM:
     return v->v.n;
   case V_STR:
-    return numexpr_sb_strtof(v->v.p.ptr);
+    return numexpr_sb_strtof(v_strptr(v));
   case V_PTR:
     return v->v.ap.p;
   case V_MAP:
@@ -102,7 +102,7 @@ static inline var_int_t v_igetval(var_t *v) {
   case V_NUM:
     return v->v.n;
   case V_STR:
-    return numexpr_strtol(v->v.p.ptr);
+    return numexpr_strtol(v_strptr(v));
   case V_PTR:
     return v->v.ap.p;
   case V_MAP:
@@ -158,6 +158,53 @@ static inline var_t *code_getvarptr_parens(int until_parens) {
   return var_p;
 }
 
+/**
+ * @ingroup exec
+ *
+ * returns whether var_p, resolved from the code at ip, is the variable itself
+ * rather than an element or field held in array or map storage
+ */
+static inline int code_is_plainvar(bcip_t ip, const var_t *var_p) {
+  return prog_source[ip] == kwTYPE_VAR && tvar[code_peekaddr(ip + 1)] == var_p;
+}
+
+/**
+ * @ingroup exec
+ *
+ * returns the array when the next code is an indexed element of one and
+ * moves the IP to the index, otherwise returns NULL
+ */
+static inline var_t *code_getarray(void) {
+  if (code_peek() == kwTYPE_VAR) {
+    var_t *var_p = tvar[code_peekaddr(prog_ip + 1)];
+    if (var_p->type == V_ARRAY && prog_source[prog_ip + 1 + ADDRSZ] == kwTYPE_LEVEL_BEGIN) {
+      prog_ip += 1 + ADDRSZ;
+      return var_p;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @ingroup exec
+ *
+ * returns the packed array when the next code is an indexed element of one
+ * and moves the IP to the index, otherwise returns NULL
+ *
+ * [kwTYPE_VAR][addr][kwTYPE_LEVEL_BEGIN]
+ */
+static inline var_t *code_getpacked(void) {
+  if (code_peek() == kwTYPE_VAR) {
+    var_t *var_p = tvar[code_peekaddr(prog_ip + 1)];
+    if (var_p->type == V_ARRAY && v_is_packed(var_p) &&
+        prog_source[prog_ip + 1 + ADDRSZ] == kwTYPE_LEVEL_BEGIN) {
+      prog_ip += 1 + ADDRSZ;
+      return var_p;
+    }
+  }
+  return NULL;
+}
+
 /**
  * @ingroup var
  *
@@ -168,9 +215,40 @@ static inline var_t *code_getvarptr_parens(int until_parens) {
 static inline void v_init(var_t *v) {
   v->type = V_INT;
   v->const_flag = 0;
+  v->pack_type = V_PACK_NONE;
+  v->maxdim = 1;
   v->v.i = 0;
 }
 
+/**
+ * @ingroup var
+ *
+ * returns element i of the array for reading. the value of a packed element
+ * is copied into tmp, which then needs no v_free()
+ *
+ * @param var the array
+ * @param i the zero-based index
+ * @param tmp holds the value of a packed element
+ */
+static inline var_t *v_array_get(var_t *var, uint32_t i, var_t *tmp) {
+  switch (var->pack_type) {
+  case V_PACK_INT:
+    tmp->type = V_INT;
+    tmp->const_flag = 0;
+    tmp->pack_type = V_PACK_NONE;
+    tmp->v.i = v_idata(var)[i];
+    return tmp;
+  case V_PACK_NUM:
+    tmp->type = V_NUM;
+    tmp->const_flag = 0;
+    tmp->pack_type = V_PACK_NONE;
+    tmp->v.n = v_ndata(var)[i];
+    return tmp;
+  default:
+    return &var->v.a.data[i];
+  }
+}
+
 /**
  * @ingroup var
  *
@@ -196,12 +274,15 @@ static inline void v_detach(var_t *v) {
 static inline void v_free(var_t *v) {
   switch (v->type) {
   case V_STR:
-    if (v->v.p.owner) {
+    if (v->v.p.owner == V_STR_OWNER) {
       free(v->v.p.ptr);
     }
     break;
   case V_ARRAY:
     v_array_free(v);
+    if (v->maxdim > 1) {
+      free(v->v.a.dim.dims);
+    }
     break;
   case V_MAP:
     map_free(v);
@@ -32,6 +32,22 @@ struct key_map_s {
 
 key_map_s *keymap = 0;
 
+/**
+ * runs the SUB or FUNC handler at the given ip then resumes at the current ip
+ */
+static void keymap_call(bcip_t handler) {
+  bcip_t ip = prog_ip; // store current ip
+  prog_ip = handler;   // jump to handler ip
+  bc_loop(1);          // invoke the handler code
+  prog_ip = ip;        // restore the current ip
+
+  // discard a FUNC handler's result
+  stknode_t *node = code_stackpeek();
+  if (node != NULL && node->type == kwTYPE_RET) {
+    code_pop_and_free();
+  }
+}
+
 /**
  * Prepare task_t exec.keymap for keymap handling at program init
  */
@@ -112,10 +128,7 @@ int keymap_invoke(uint32_t key) {
   key_map_s *head = keymap;
   while (head) {
     if (head->key == key) {
-      bcip_t ip = prog_ip; // store current ip
-      prog_ip = head->ip;  // jump to keymap ip
-      bc_loop(1);          // invoke the keymap code
-      prog_ip = ip;        // restore the current ip
+      keymap_call(head->ip);
       result = 1;          // key was consumed
     }
     head = head->next;
@@ -229,10 +242,7 @@ void timer_run(uint32_t now) {
     } else if (now > timer->value && !timer->active) {
       // timer expired
       timer->active = 1;
-      bcip_t ip = prog_ip;
-      prog_ip = timer->ip;
-      bc_loop(1);
-      prog_ip = ip;
+      keymap_call(timer->ip);
 
       // reset for next interval
       timer->value = now + timer->interval;
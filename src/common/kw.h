@@ -176,6 +176,12 @@ enum keyword {
   kwCATCH,
   kwENDTRY,
   kwFUNC_RETURN,
+  kwLET_ADD_INT, /* LET v = v +/- int (superinstruction) */
+  kwLET_ELEM_INT, /* LET v = a(int) (superinstruction) */
+  kwPRINT_VAR, /* PRINT v (superinstruction) */
+  kwTYPE_VAR_OPR_INT, /* v +/-/cmp int in an expression (superinstruction) */
+  kwTAIL_CALL, /* LET rv = f(...) before a FUNC RETURN (superinstruction) */
+  kwLET_APPEND, /* LET s = s + expr (superinstruction) */
   kwNULL
 };
 
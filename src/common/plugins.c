@@ -362,10 +362,11 @@ static void slib_import_routines(slib_t *lib, int comp) {
 // execute a function or procedure
 //
 static int slib_exec(slib_t *lib, var_t *ret, int index, int proc) {
+  slib_par_t params[MAX_PARAM];
   slib_par_t *ptable;
   int pcount;
   if (code_peek() == kwTYPE_LEVEL_BEGIN) {
-    ptable = (slib_par_t *)malloc(sizeof(slib_par_t) * MAX_PARAM);
+    ptable = params;
     pcount = plugin_build_ptable(ptable, MAX_PARAM);
   } else {
     ptable = NULL;
@@ -373,7 +374,6 @@ static int slib_exec(slib_t *lib, var_t *ret, int index, int proc) {
   }
   if (prog_error) {
     plugin_free_ptable(ptable, pcount);
-    free(ptable);
     return 0;
   }
 
@@ -388,7 +388,7 @@ static int slib_exec(slib_t *lib, var_t *ret, int index, int proc) {
   // error
   if (!success) {
     if (ret->type == V_STR) {
-      err_throw("LIB:%s: %s\n", lib->_name, ret->v.p.ptr);
+      err_throw("LIB:%s: %s\n", lib->_name, v_strptr(ret));
     } else {
       err_throw("LIB:%s: Unspecified error calling %s\n", lib->_name, (proc ? "SUB" : "FUNC"));
     }
@@ -397,7 +397,6 @@ static int slib_exec(slib_t *lib, var_t *ret, int index, int proc) {
   // clean-up
   if (ptable) {
     plugin_free_ptable(ptable, pcount);
-    free(ptable);
   }
 
   if (success && v_is_type(ret, V_MAP)) {
@@ -597,6 +596,7 @@ int plugin_build_ptable(slib_par_t *ptable, int size) {
           // push parameter
           ptable[pcount].var_p = code_getvarptr();
           ptable[pcount].byref = 1;
+          v_strheap(ptable[pcount].var_p);
           pcount++;
           break;
         }
@@ -610,6 +610,7 @@ int plugin_build_ptable(slib_par_t *ptable, int size) {
         eval(arg);
         if (!prog_error) {
           // push parameter
+          v_strheap(arg);
           ptable[pcount].var_p = arg;
           ptable[pcount].byref = 0;
           pcount++;
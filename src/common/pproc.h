@@ -65,6 +65,16 @@ void bc_loop(int isf);
  */
 void eval(var_t *result);
 
+/**
+ * @ingroup exec
+ *
+ * evaluate the right operand of a binary operator. the operand ends
+ * at the kwTYPE_EVPOP which returns the left operand.
+ *
+ * @param result the variable to store the result.
+ */
+void eval_operand(var_t *result);
+
 /**
  * @ingroup exec
  *
@@ -151,34 +151,30 @@ void exec_usefunc2(var_t *var1, var_t *var2, bcip_t ip) {
   v_detach(old_y);
 }
 
-void pv_write_str(char *str, var_t *vp) {
-  vp->v.p.length += strlen(str);
-  if (vp->v.p.ptr == NULL) {
-    vp->v.p.ptr = malloc(vp->v.p.length + 1);
-    vp->v.p.owner = 1;
-    strcpy(vp->v.p.ptr, str);
-  } else {
-    vp->v.p.ptr = realloc(vp->v.p.ptr, vp->v.p.length + 1);
-    strcat(vp->v.p.ptr, str);
-  }
+/*
+ * Append to the string variable of SPRINT. the buffer grows geometrically
+ * and the text is written at the stored length
+ */
+void pv_write_str(const char *str, int len, var_t *vp) {
+  v_strncat(vp, str, len);
 }
 
 void pv_write_str_var(var_t *var, int method, intptr_t handle) {
   switch (method) {
   case PV_FILE:
-    dev_fwrite((int)handle, (byte *)var->v.p.ptr, var->v.p.length - 1);
+    dev_fwrite((int)handle, (byte *)v_strptr(var), var->v.p.length - 1);
     break;
   case PV_LOG:
-    lwrite(var->v.p.ptr);
+    lwrite(v_strptr(var));
     break;
   case PV_STRING:
-    pv_write_str(var->v.p.ptr, (var_t *)handle);
+    pv_write_str(v_strptr(var), v_strlen(var), (var_t *)handle);
     break;
   case PV_NET:
-    net_send((socket_t)handle, (const char *)var->v.p.ptr, var->v.p.length - 1);
+    net_send((socket_t)handle, (const char *)v_strptr(var), var->v.p.length - 1);
     break;
   default:
-    dev_print(var->v.p.ptr);
+    dev_print(v_strptr(var));
   }
 }
 
@@ -194,7 +190,7 @@ void pv_write(char *str, int method, intptr_t handle) {
     lwrite(str);
     break;
   case PV_STRING:
-    pv_write_str(str, (var_t *)handle);
+    pv_write_str(str, strlen(str), (var_t *)handle);
     break;
   case PV_NET:
     net_print((socket_t)handle, (const char *)str);
@@ -288,6 +284,9 @@ void par_skip() {
     case kwTYPE_VAR:           // [addr|id]
       prog_ip += ADDRSZ + 1;
       break;
+    case kwTYPE_VAR_OPR_INT:   // [addr] [EVPUSH] [INT][int] [EVPOP] [opr][op]
+      prog_ip += BC_VAR_OPR_INT_LEN;
+      break;
     case kwTYPE_CALLF:
       prog_ip += CODESZ + 1;
       break;
@@ -416,7 +416,7 @@ int err_throw_catch(const char *err, var_t **catch_var) {
     v_init(&v_catch);
     eval(&v_catch);
     // catch is conditional on matching error
-    caught = (v_catch.type == V_STR && strstr(err, v_catch.v.p.ptr) != NULL);
+    caught = (v_catch.type == V_STR && strstr(err, v_strptr(&v_catch)) != NULL);
     v_free(&v_catch);
     break;
   case kwTYPE_EOC:
@@ -539,7 +539,7 @@ void cmd_throw() {
     if (code != kwTYPE_EOC && code != kwTYPE_LINE) {
       eval(&v_throw);
       if (v_throw.type == V_STR) {
-        err = v_throw.v.p.ptr;
+        err = v_strptr(&v_throw);
       }
     }
     err_throw_str(err);
@@ -101,6 +101,112 @@ void memcat(char *dest, char *p) {
   dest[lenb + lenp] = '\0';
 }
 
+/*
+ * hash of the name for the comp_index_t tables
+ */
+static inline uint32_t comp_index_hash(const char *name) {
+  uint32_t hash = 2166136261u;
+  for (const char *p = name; *p; p++) {
+    hash ^= (byte)*p;
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 16);
+}
+
+static void comp_index_init(comp_index_t *index) {
+  index->slots = NULL;
+  index->size = 0;
+  index->count = 0;
+}
+
+static void comp_index_free(comp_index_t *index) {
+  free(index->slots);
+  comp_index_init(index);
+}
+
+/*
+ * returns the table position of the name or -1 when not found
+ */
+static bid_t comp_index_find(const comp_index_t *index, const char *name) {
+  if (index->size) {
+    uint32_t hash = comp_index_hash(name);
+    uint32_t mask = index->size - 1;
+    for (uint32_t i = hash & mask; index->slots[i].name != NULL; i = (i + 1) & mask) {
+      if (index->slots[i].hash == hash && strcmp(index->slots[i].name, name) == 0) {
+        return index->slots[i].id;
+      }
+    }
+  }
+  return -1;
+}
+
+static void comp_index_insert(comp_index_slot_t *slots, uint32_t mask, const comp_index_slot_t *slot) {
+  uint32_t i = slot->hash & mask;
+  while (slots[i].name != NULL) {
+    i = (i + 1) & mask;
+  }
+  slots[i] = *slot;
+}
+
+/*
+ * adds the name held by table position id. the name must remain in place
+ * while it is indexed. an existing entry for the name is kept
+ */
+static void comp_index_add(comp_index_t *index, const char *name, bid_t id) {
+  if (comp_index_find(index, name) != -1) {
+    return;
+  }
+  if ((index->count + 1) * 2 > index->size) {
+    // keep the slots at most half full
+    uint32_t size = index->size ? index->size * 2 : GROWSIZE;
+    comp_index_slot_t *slots = (comp_index_slot_t *)calloc(size, sizeof(comp_index_slot_t));
+    for (uint32_t i = 0; i < index->size; i++) {
+      if (index->slots[i].name != NULL) {
+        comp_index_insert(slots, size - 1, &index->slots[i]);
+      }
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->size = size;
+  }
+  comp_index_slot_t slot;
+  slot.name = name;
+  slot.hash = comp_index_hash(name);
+  slot.id = id;
+  comp_index_insert(index->slots, index->size - 1, &slot);
+  index->count++;
+}
+
+// indexes of the built-in keyword tables, shared by all tasks
+static comp_index_t keyword_index;
+static comp_index_t func_index;
+static comp_index_t proc_index;
+static comp_index_t spopr_index;
+static comp_index_t opr_index;
+
+/*
+ * builds the keyword table indexes on first use
+ */
+static void comp_init_keyword_index() {
+  if (keyword_index.size == 0) {
+    for (int i = 0; keyword_table[i].name[0] != '\0'; i++) {
+      comp_index_add(&keyword_index, keyword_table[i].name, i);
+    }
+    for (int i = 0; func_table[i].name[0] != '\0'; i++) {
+      comp_index_add(&func_index, func_table[i].name, i);
+    }
+    for (int i = 0; proc_table[i].name[0] != '\0'; i++) {
+      comp_index_add(&proc_index, proc_table[i].name, i);
+    }
+    for (int i = 0; spopr_table[i].name[0] != '\0'; i++) {
+      comp_index_add(&spopr_index, spopr_table[i].name, i);
+    }
+    for (int i = 0; opr_table[i].name[0] != '\0'; i++) {
+      comp_index_add(&opr_index, opr_table[i].name, i);
+    }
+  }
+}
+
 /*
  * reset the external proc/func lists
  */
@@ -280,17 +386,11 @@ char *comp_prepare_name(char *dest, const char *source, int size) {
  * returns the ID of the label. If there is no one, then it creates one
  */
 bid_t comp_label_getID(const char *label_name) {
-  bid_t idx = -1, i;
+  bid_t idx;
   char name[SB_KEYWORD_SIZE + 1];
 
   comp_prepare_name(name, label_name, SB_KEYWORD_SIZE);
-
-  for (i = 0; i < comp_labtable.count; i++) {
-    if (strcmp(comp_labtable.elem[i]->name, name) == 0) {
-      idx = i;
-      break;
-    }
-  }
+  idx = comp_index_find(&comp_labindex, name);
 
   if (idx == -1) {
     if (opt_verbose) {
@@ -313,6 +413,7 @@ bid_t comp_label_getID(const char *label_name) {
     comp_labtable.elem[comp_labtable.count] = label;
     idx = comp_labtable.count;
     comp_labtable.count++;
+    comp_index_add(&comp_labindex, label->name, idx);
   }
 
   return idx;
@@ -371,11 +472,10 @@ bid_t comp_udp_id(const char *proc_name, int scan_tree) {
         strcpy(name, base);
       }
       // search on local
-      for (i = 0; i < comp_udpcount; i++) {
-        if (strcmp(comp_udptable[i].name, name) == 0) {
-          free(root);
-          return i;
-        }
+      i = comp_index_find(&comp_udpindex, name);
+      if (i != -1) {
+        free(root);
+        return i;
       }
     } while (len);
 
@@ -385,10 +485,9 @@ bid_t comp_udp_id(const char *proc_name, int scan_tree) {
     comp_prepare_udp_name(name, proc_name);
 
     // search on local
-    for (i = 0; i < comp_udpcount; i++) {
-      if (strcmp(comp_udptable[i].name, name) == 0) {
-        return i;
-      }
+    i = comp_index_find(&comp_udpindex, name);
+    if (i != -1) {
+      return i;
     }
   }
 
@@ -401,7 +500,7 @@ bid_t comp_udp_id(const char *proc_name, int scan_tree) {
  */
 bid_t comp_add_udp(const char *proc_name) {
   char *name = comp_bc_temp;
-  bid_t idx = -1, i;
+  bid_t idx;
   comp_prepare_udp_name(name, proc_name);
 
   /*
@@ -412,12 +511,7 @@ bid_t comp_add_udp(const char *proc_name) {
    */
 
   // search
-  for (i = 0; i < comp_udpcount; i++) {
-    if (strcmp(comp_udptable[i].name, name) == 0) {
-      idx = i;
-      break;
-    }
-  }
+  idx = comp_index_find(&comp_udpindex, name);
 
   if (idx == -1) {
     if (comp_udpcount >= comp_udpsize) {
@@ -439,6 +533,7 @@ bid_t comp_add_udp(const char *proc_name) {
       strcpy(comp_udptable[comp_udpcount].name, name);
       idx = comp_udpcount;
       comp_udpcount++;
+      comp_index_add(&comp_udpindex, comp_udptable[idx].name, idx);
     }
   }
 
@@ -629,6 +724,7 @@ int comp_create_var(const char *name) {
     comp_vartable[comp_varcount].local_proc_level = 0;
     idx = comp_varcount;
     comp_varcount++;
+    comp_index_add(&comp_varindex, comp_vartable[idx].name, idx);
   }
   return idx;
 }
@@ -701,25 +797,17 @@ bid_t comp_var_getID(const char *var_name) {
   // however a global var-ID per var-name is required
   //
   strcpy(name, tmp);
-
-  for (i = 0; i < comp_varcount; i++) {
-    if (strcmp(comp_vartable[i].name, name) == 0) {
+  idx = comp_index_find(&comp_varindex, name);
+
+  int len = strlen(name);
+  if (len > 1 && name[len - 1] == '$') {
+    // system variables must be visible with or without '$' suffix
+    name[len - 1] = '\0';
+    i = comp_index_find(&comp_varindex, name);
+    if (i != -1 && comp_vartable[i].dolar_sup && (idx == -1 || i < idx)) {
       idx = i;
-      break;
-    }
-
-    if (comp_vartable[i].dolar_sup) {
-      // system variables must be visible with or without '$' suffix
-      char *dollar_name = malloc(strlen(comp_vartable[i].name) + 2);
-      strcpy(dollar_name, comp_vartable[i].name);
-      strcat(dollar_name, "$");
-      if (strcmp(dollar_name, name) == 0) {
-        idx = i;
-        free(dollar_name);
-        break;
-      }
-      free(dollar_name);
     }
+    name[len - 1] = '$';
   }
 
   if (opt_autolocal) {
@@ -853,10 +941,9 @@ int comp_is_keyword(const char *name) {
     dolar_sup++;
   }
 
-  for (i = 0; keyword_table[i].name[0] != '\0'; i++) {
-    if (strcmp(keyword_table[i].name, name) == 0) {
-      return keyword_table[i].code;
-    }
+  i = comp_index_find(&keyword_index, name);
+  if (i != -1) {
+    return keyword_table[i].code;
   }
 
   if (dolar_sup) {
@@ -885,10 +972,9 @@ bid_t comp_is_func(const char *name) {
     dolar_sup++;
   }
 
-  for (i = 0; func_table[i].name[0] != '\0'; i++) {
-    if (strcmp(func_table[i].name, name) == 0) {
-      return func_table[i].fcode;
-    }
+  i = comp_index_find(&func_index, name);
+  if (i != -1) {
+    return func_table[i].fcode;
   }
 
   if (dolar_sup) {
@@ -904,10 +990,9 @@ bid_t comp_is_func(const char *name) {
 bid_t comp_is_proc(const char *name) {
   bid_t i;
 
-  for (i = 0; proc_table[i].name[0] != '\0'; i++) {
-    if (strcmp(proc_table[i].name, name) == 0) {
-      return proc_table[i].pcode;
-    }
+  i = comp_index_find(&proc_index, name);
+  if (i != -1) {
+    return proc_table[i].pcode;
   }
 
   return -1;
@@ -919,25 +1004,47 @@ bid_t comp_is_proc(const char *name) {
 int comp_is_special_operator(const char *name) {
   int i;
 
-  for (i = 0; spopr_table[i].name[0] != '\0'; i++) {
-    if (strcmp(spopr_table[i].name, name) == 0) {
-      return spopr_table[i].code;
-    }
+  i = comp_index_find(&spopr_index, name);
+  if (i != -1) {
+    return spopr_table[i].code;
   }
 
   return -1;
 }
 
+/*
+ * returns the packed array type named after AS, or V_PACK_NONE
+ */
+int comp_array_type(const char *text) {
+  char name[SB_KEYWORD_SIZE + 1];
+  const char *p = text;
+  int i = 0;
+
+  SKIP_SPACES(p);
+  while (is_alpha(*p) && i < SB_KEYWORD_SIZE) {
+    name[i++] = *p++;
+  }
+  name[i] = '\0';
+  SKIP_SPACES(p);
+  if (*p != '\0' && *p != ',' && *p != '\'') {
+    return V_PACK_NONE;
+  } else if (strcmp(name, LCN_INTEGER) == 0) {
+    return V_PACK_INT;
+  } else if (strcmp(name, LCN_REAL) == 0) {
+    return V_PACK_NUM;
+  }
+  return V_PACK_NONE;
+}
+
 /*
  * returns the keyword code (operators)
  */
 int comp_is_operator(const char *name) {
   int i;
 
-  for (i = 0; opr_table[i].name[0] != '\0'; i++) {
-    if (strcmp(opr_table[i].name, name) == 0) {
-      return ((opr_table[i].code << 8) | opr_table[i].opr);
-    }
+  i = comp_index_find(&opr_index, name);
+  if (i != -1) {
+    return ((opr_table[i].code << 8) | opr_table[i].opr);
   }
 
   return -1;
@@ -1251,6 +1358,12 @@ void comp_expression(char *expr, byte no_parser) {
             comp_use_global_vartable = 1;
             // all the next variables are global (needed for X)
             check_udf++;
+          } else if (idx == kwAS && comp_array_type(ptr) != V_PACK_NONE) {
+            // DIM v(...) AS INTEGER|REAL
+            bc_add_code(&bc, idx);
+            bc_add_code(&bc, kwTYPE_SEP);
+            bc_add_code(&bc, comp_array_type(ptr));
+            ptr = (char *)comp_next_word(ptr, comp_bc_name);
           } else if (idx == kwDO) {
             SKIP_SPACES(ptr);
             if (strlen(ptr)) {
@@ -3046,6 +3159,7 @@ bcip_t comp_next_bc_cmd(bc_t *bc, bcip_t ip) {
   case kwGOSUB:
   case kwTYPE_LINE:
   case kwTYPE_VAR:             // [addr|id]
+  case kwTYPE_VAR_OPR_INT:
   case kwFUNC_RETURN:
     ip += ADDRSZ;
     break;
@@ -3099,23 +3213,33 @@ bcip_t comp_next_bc_cmd(bc_t *bc, bcip_t ip) {
 }
 
 /*
- * search for command (in byte-code)
+ * search for command (in byte-code) before the given end
  */
-bcip_t comp_search_bc(bcip_t ip, code_t code) {
+static bcip_t comp_search_bc_until(bcip_t ip, bcip_t end, code_t code) {
   bcip_t i = ip;
   bcip_t result = INVALID_ADDR;
+  if (end > comp_prog.count) {
+    end = comp_prog.count;
+  }
   do {
-    if (i >= comp_prog.count) {
+    if (i >= end) {
       break;
     } else if (code == comp_prog.ptr[i]) {
       result = i;
       break;
     }
     i = comp_next_bc_cmd(&comp_prog, i);
-  } while (i < comp_prog.count);
+  } while (i < end);
   return result;
 }
 
+/*
+ * search for command (in byte-code)
+ */
+bcip_t comp_search_bc(bcip_t ip, code_t code) {
+  return comp_search_bc_until(ip, comp_prog.count, code);
+}
+
 /*
  * search for End-Of-Command mark
  */
@@ -3134,17 +3258,133 @@ bcip_t comp_search_bc_eoc(bcip_t ip) {
 }
 
 /*
- * search stack
+ * the pass-2 stack nodes grouped by code, level and block_id, each group
+ * in stack order. the block searches are made from an increasing stack
+ * position, so the group cursor moves forward over the whole of pass-2
  */
-bcip_t comp_search_bc_stack(bcip_t start, code_t code, byte level, bid_t block_id) {
-  for (bcip_t i = start; i < comp_sp; i++) {
+typedef struct {
+  bid_t block_id; /**< -1 for the group of all blocks */
+  code_t code;
+  byte level;
+  uint32_t start; /**< position of the first member */
+  uint32_t count; /**< number of members, empty when 0 */
+  uint32_t cursor; /**< the members before the cursor precede the last search */
+} comp_pass2_group_t;
+
+static struct {
+  comp_pass2_group_t *groups; /**< open addressing slots */
+  uint32_t size; /**< number of slots, a power of 2 */
+  bcip_t *members; /**< the stack indexes of all groups */
+} comp_pass2_index;
+
+static inline uint32_t comp_pass2_hash(code_t code, byte level, bid_t block_id) {
+  uint32_t hash = ((uint32_t)block_id * 2654435761u) ^ ((uint32_t)code << 8) ^ level;
+  return hash ^ (hash >> 15);
+}
+
+/*
+ * returns the group of the key, or the empty slot where it belongs
+ */
+static comp_pass2_group_t *comp_pass2_group(code_t code, byte level, bid_t block_id) {
+  uint32_t mask = comp_pass2_index.size - 1;
+  uint32_t i = comp_pass2_hash(code, level, block_id) & mask;
+  comp_pass2_group_t *group = &comp_pass2_index.groups[i];
+  while (group->count != 0 &&
+         (group->code != code || group->level != level || group->block_id != block_id)) {
+    i = (i + 1) & mask;
+    group = &comp_pass2_index.groups[i];
+  }
+  return group;
+}
+
+static void comp_pass2_group_add(comp_pass2_group_t *group, code_t code, byte level, bid_t block_id) {
+  group->code = code;
+  group->level = level;
+  group->block_id = block_id;
+  group->count++;
+}
+
+/*
+ * builds the pass-2 stack groups
+ */
+static void comp_pass2_index_create() {
+  uint32_t size = GROWSIZE;
+  while (size < (uint32_t)comp_sp * 4) {
+    // two groups per node, at most half full
+    size <<= 1;
+  }
+  comp_pass2_index.size = size;
+  comp_pass2_index.groups = (comp_pass2_group_t *)calloc(size, sizeof(comp_pass2_group_t));
+  comp_pass2_index.members = (bcip_t *)malloc(comp_sp * 2 * sizeof(bcip_t));
+
+  // size the groups
+  for (bcip_t i = 0; i < comp_sp; i++) {
     comp_pass_node_t *node = comp_stack.elem[i];
-    if (comp_prog.ptr[node->pos] == code) {
-      if (node->level == level && (block_id == -1 || block_id == node->block_id)) {
-        return node->pos;
-      }
+    code_t code = comp_prog.ptr[node->pos];
+    comp_pass2_group_add(comp_pass2_group(code, node->level, -1), code, node->level, -1);
+    comp_pass2_group_add(comp_pass2_group(code, node->level, node->block_id), code, node->level, node->block_id);
+  }
+
+  uint32_t start = 0;
+  for (uint32_t i = 0; i < size; i++) {
+    comp_pass2_group_t *group = &comp_pass2_index.groups[i];
+    if (group->count != 0) {
+      group->start = start;
+      start += group->count;
     }
   }
+
+  // fill the groups in stack order
+  for (bcip_t i = 0; i < comp_sp; i++) {
+    comp_pass_node_t *node = comp_stack.elem[i];
+    code_t code = comp_prog.ptr[node->pos];
+    comp_pass2_group_t *group = comp_pass2_group(code, node->level, -1);
+    comp_pass2_index.members[group->start + group->cursor++] = i;
+    group = comp_pass2_group(code, node->level, node->block_id);
+    comp_pass2_index.members[group->start + group->cursor++] = i;
+  }
+  for (uint32_t i = 0; i < size; i++) {
+    comp_pass2_index.groups[i].cursor = 0;
+  }
+}
+
+static void comp_pass2_index_free() {
+  free(comp_pass2_index.groups);
+  free(comp_pass2_index.members);
+  comp_pass2_index.groups = NULL;
+  comp_pass2_index.members = NULL;
+  comp_pass2_index.size = 0;
+}
+
+/*
+ * returns the group of the key with the cursor at the first member at or
+ * after the given stack position, NULL when there are no members
+ */
+static comp_pass2_group_t *comp_pass2_seek(bcip_t start, code_t code, byte level, bid_t block_id) {
+  comp_pass2_group_t *group = comp_pass2_group(code, level, block_id);
+  if (group->count == 0) {
+    return NULL;
+  }
+  const bcip_t *members = comp_pass2_index.members + group->start;
+  if (group->cursor > 0 && members[group->cursor - 1] >= start) {
+    // searching from an earlier position
+    group->cursor = 0;
+  }
+  while (group->cursor < group->count && members[group->cursor] < start) {
+    group->cursor++;
+  }
+  return group;
+}
+
+/*
+ * search stack
+ */
+bcip_t comp_search_bc_stack(bcip_t start, code_t code, byte level, bid_t block_id) {
+  comp_pass2_group_t *group = comp_pass2_seek(start, code, level, block_id);
+  if (group != NULL && group->cursor < group->count) {
+    bcip_t i = comp_pass2_index.members[group->start + group->cursor];
+    return comp_stack.elem[i]->pos;
+  }
   return INVALID_ADDR;
 }
 
@@ -3152,15 +3392,11 @@ bcip_t comp_search_bc_stack(bcip_t start, code_t code, byte level, bid_t block_i
  * search stack backward
  */
 bcip_t comp_search_bc_stack_backward(bcip_t start, code_t code, byte level, bid_t block_id) {
-  for (bcip_t i = start; i < comp_sp; i--) {
-    // WARNING: ITS UNSIGNED, SO WE'LL SEARCH
-    // IN RANGE [0..STK_COUNT]
-    comp_pass_node_t *node = comp_stack.elem[i];
-    if (comp_prog.ptr[node->pos] == code) {
-      if (node->level == level && (block_id == -1 || block_id == node->block_id)) {
-        return node->pos;
-      }
-    }
+  // the start is -1 from the first node, which finds nothing
+  comp_pass2_group_t *group = comp_pass2_seek(start + 1, code, level, block_id);
+  if (group != NULL && group->cursor > 0) {
+    bcip_t i = comp_pass2_index.members[group->start + group->cursor - 1];
+    return comp_stack.elem[i]->pos;
   }
   return INVALID_ADDR;
 }
@@ -3456,13 +3692,6 @@ void comp_pass2_scan() {
       break;
 
     case kwFOR:
-      a_ip = comp_search_bc(node->pos + (ADDRSZ + ADDRSZ + 1), kwTO);
-      b_ip = comp_search_bc(node->pos + (ADDRSZ + ADDRSZ + 1), kwIN);
-      if (a_ip < b_ip) {
-        b_ip = INVALID_ADDR;
-      } else if (a_ip > b_ip) {
-        a_ip = b_ip;
-      }
       false_ip = comp_search_bc_stack(i + 1, kwNEXT, node->level, -1);
 
       if (false_ip == INVALID_ADDR) {
@@ -3470,7 +3699,16 @@ void comp_pass2_scan() {
         print_pass2_stack(i, kwNEXT, node->level);
         return;
       }
-      if (a_ip > false_ip || a_ip == INVALID_ADDR) {
+
+      // TO or IN must be found before the NEXT, don't search beyond it
+      a_ip = comp_search_bc_until(node->pos + (ADDRSZ + ADDRSZ + 1), false_ip, kwTO);
+      b_ip = comp_search_bc_until(node->pos + (ADDRSZ + ADDRSZ + 1), false_ip, kwIN);
+      if (a_ip < b_ip) {
+        b_ip = INVALID_ADDR;
+      } else if (a_ip > b_ip) {
+        a_ip = b_ip;
+      }
+      if (a_ip == INVALID_ADDR) {
         if (b_ip != INVALID_ADDR) {
           sc_raise(MSG_MISSING_IN);
         } else {
@@ -3747,11 +3985,160 @@ bcip_t comp_optimise_line_goto(bcip_t ip) {
   return ip;
 }
 
+// whether the code at ip ends the statement
+int comp_is_eoc(bcip_t ip) {
+  return (ip >= comp_prog.count ||
+          comp_prog.ptr[ip] == kwTYPE_EOC ||
+          comp_prog.ptr[ip] == kwTYPE_LINE);
+}
+
+// match [VAR] [EVPUSH] [INT] [EVPOP] [ADDOPR|CMPOPR] for kwTYPE_VAR_OPR_INT
+int comp_is_var_opr_int(bcip_t ip, int add_only) {
+  code_t *bc = comp_prog.ptr + ip;
+  int result = 0;
+  if (ip + BC_VAR_OPR_INT_LEN <= comp_prog.count &&
+      bc[0] == kwTYPE_VAR &&
+      bc[ADDRSZ + 1] == kwTYPE_EVPUSH &&
+      bc[ADDRSZ + 2] == kwTYPE_INT &&
+      bc[BC_VAR_OPR_INT_OPR - 1] == kwTYPE_EVPOP) {
+    code_t op = bc[BC_VAR_OPR_INT_OPR + 1];
+    switch (bc[BC_VAR_OPR_INT_OPR]) {
+    case kwTYPE_ADDOPR:
+      result = (op == '+' || op == '-');
+      break;
+    case kwTYPE_CMPOPR:
+      result = !add_only && (op == OPLOG_EQ || op == OPLOG_GT || op == OPLOG_GE ||
+                             op == OPLOG_LT || op == OPLOG_LE || op == OPLOG_NE);
+      break;
+    default:
+      break;
+    }
+  }
+  return result;
+}
+
+// LET v = v +/- int
+int comp_is_let_add_int(bcip_t ip) {
+  bcip_t rhs = ip + ADDRSZ + 4;
+  return (comp_is_var_opr_int(rhs, 1) &&
+          memcmp(comp_prog.ptr + ip + 2, comp_prog.ptr + rhs + 1, ADDRSZ) == 0 &&
+          comp_is_eoc(rhs + BC_VAR_OPR_INT_LEN));
+}
+
+// LET s = s + a [+ b ...], where each operand is complete and cannot call
+// user code which might modify s before the append
+int comp_is_let_append(bcip_t ip) {
+  bcip_t rhs = ip + ADDRSZ + 4;
+  bcip_t end = rhs + ADDRSZ + 1;
+  if (end >= comp_prog.count ||
+      comp_prog.ptr[rhs] != kwTYPE_VAR ||
+      memcmp(comp_prog.ptr + ip + 2, comp_prog.ptr + rhs + 1, ADDRSZ) != 0) {
+    return 0;
+  }
+  int operands = 0;
+  while (comp_prog.ptr[end] == kwTYPE_EVPUSH && ++operands <= BC_LET_APPEND_MAX) {
+    bcip_t start = ++end;
+    int level = 0;
+    while (!comp_is_eoc(end) && (level || comp_prog.ptr[end] != kwTYPE_EVPOP)) {
+      switch (comp_prog.ptr[end]) {
+      case kwTYPE_EVPUSH:
+        level++;
+        break;
+      case kwTYPE_EVPOP:
+        level--;
+        break;
+      case kwTYPE_CALL_UDF:
+      case kwTYPE_CALL_PTR:
+      case kwTYPE_CALLEXTF:
+      case kwTYPE_UDS_EL:
+        return 0;
+      default:
+        break;
+      }
+      end = comp_next_bc_cmd(&comp_prog, end);
+    }
+    if (end == start || comp_is_eoc(end) ||
+        comp_prog.ptr[end + 1] != kwTYPE_ADDOPR || comp_prog.ptr[end + 2] != '+') {
+      return 0;
+    }
+    end += 3;
+    if (comp_is_eoc(end)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// LET v = a(int)
+int comp_is_let_elem_int(bcip_t ip) {
+  code_t *bc = comp_prog.ptr + ip + ADDRSZ + 4;
+  bcip_t end = ip + (ADDRSZ * 2) + OS_INTSZ + 8;
+  return (end <= comp_prog.count &&
+          bc[0] == kwTYPE_VAR &&
+          bc[ADDRSZ + 1] == kwTYPE_LEVEL_BEGIN &&
+          bc[ADDRSZ + 2] == kwTYPE_INT &&
+          bc[ADDRSZ + OS_INTSZ + 3] == kwTYPE_LEVEL_END &&
+          comp_is_eoc(end));
+}
+
+// LET v = f(...) EOC RETURN, where f is a FUNC and RETURN is the FUNC's
+// return statement. kwTAIL_CALL checks v is the return variable at run-time
+int comp_is_tail_call(bcip_t ip) {
+  bcip_t call_ip = ip + ADDRSZ + 4;
+  bcip_t end = call_ip + 1 + (ADDRSZ * 2);
+  int result = 0;
+  if (end < comp_prog.count && comp_prog.ptr[call_ip] == kwTYPE_CALL_UDF) {
+    if (comp_prog.ptr[end] == kwTYPE_LEVEL_BEGIN) {
+      if (comp_prog.ptr[end + 1] == kwTYPE_CALL_PTR) {
+        return 0;
+      }
+      int level = 0;
+      do {
+        switch (comp_prog.ptr[end]) {
+        case kwTYPE_LEVEL_BEGIN:
+          level++;
+          break;
+        case kwTYPE_LEVEL_END:
+          level--;
+          break;
+        default:
+          break;
+        }
+        end = comp_next_bc_cmd(&comp_prog, end);
+      } while (level > 0 && end < comp_prog.count);
+    }
+    result = (end + 2 < comp_prog.count &&
+              comp_prog.ptr[end] == kwTYPE_EOC &&
+              comp_prog.ptr[end + 1] == kwRETURN &&
+              comp_prog.ptr[end + 2] == kwFUNC_RETURN);
+  }
+  return result;
+}
+
 // use simpler LET where possible to avoid eval on the right term
 bcip_t comp_optimise_let(bcip_t ip) {
   bcip_t ip_next = ip + 1;
   if (comp_prog.ptr[ip_next] == kwTYPE_VAR) {
     ip_next += 1 + sizeof(bcip_t);
+    if (comp_prog.ptr[ip_next] == kwTYPE_CMPOPR &&
+        comp_prog.ptr[ip_next + 1] == '=') {
+      if (comp_is_let_add_int(ip)) {
+        comp_prog.ptr[ip] = kwLET_ADD_INT;
+        return ip;
+      }
+      if (comp_is_let_elem_int(ip)) {
+        comp_prog.ptr[ip] = kwLET_ELEM_INT;
+        return ip;
+      }
+      if (comp_is_tail_call(ip)) {
+        comp_prog.ptr[ip] = kwTAIL_CALL;
+        return ip;
+      }
+      if (comp_is_let_append(ip)) {
+        comp_prog.ptr[ip] = kwLET_APPEND;
+        return ip;
+      }
+    }
     while (ip_next < comp_prog.count && comp_prog.ptr[ip_next] != kwTYPE_EOC
            && comp_prog.ptr[ip_next] != kwTYPE_LINE) {
       if (comp_prog.ptr[ip_next] == kwTYPE_CMPOPR &&
@@ -3772,7 +4159,72 @@ bcip_t comp_optimise_let(bcip_t ip) {
   return ip;
 }
 
+// count the commands in the byte-code by opcode, a superinstruction counts
+// once for the sequence it replaces
+void comp_count_opcodes(uint32_t *counts) {
+  memset(counts, 0, sizeof(uint32_t) * 256);
+  bcip_t ip = 0;
+  while (ip < comp_prog.count) {
+    code_t code = comp_prog.ptr[ip];
+    counts[code]++;
+    switch (code) {
+    case kwTYPE_VAR_OPR_INT:
+      ip += BC_VAR_OPR_INT_LEN;
+      break;
+    case kwPRINT_VAR:
+      ip += ADDRSZ + 2;
+      break;
+    case kwLET_ADD_INT:
+    case kwLET_ELEM_INT:
+      ip = comp_search_bc_eoc(ip + 1);
+      break;
+    default:
+      ip = comp_next_bc_cmd(&comp_prog, ip);
+      break;
+    }
+  }
+}
+
+// print the opcode histogram from before and after comp_optimise()
+void comp_print_opcodes(uint32_t *before, uint32_t *after) {
+  char name[64];
+  log_printf("opcode               before    after\n");
+  for (int i = 0; i < 256; i++) {
+    if (before[i] || after[i]) {
+      switch (i) {
+      case kwLET_ADD_INT:
+        strcpy(name, "LET_ADD_INT");
+        break;
+      case kwLET_ELEM_INT:
+        strcpy(name, "LET_ELEM_INT");
+        break;
+      case kwPRINT_VAR:
+        strcpy(name, "PRINT_VAR");
+        break;
+      case kwTYPE_VAR_OPR_INT:
+        strcpy(name, "$var_opr_int");
+        break;
+      case kwTAIL_CALL:
+        strcpy(name, "TAIL_CALL");
+        break;
+      case kwLET_APPEND:
+        strcpy(name, "LET_APPEND");
+        break;
+      default:
+        kw_getcmdname(i, name);
+        break;
+      }
+      log_printf("%-16s %10u %8u\n", name, before[i], after[i]);
+    }
+  }
+}
+
 void comp_optimise() {
+  uint32_t *before = NULL;
+  if (opt_verbose) {
+    before = malloc(sizeof(uint32_t) * 256);
+    comp_count_opcodes(before);
+  }
   for (bcip_t ip = 0; !comp_error && ip < comp_prog.count;
        ip = comp_next_bc_cmd(&comp_prog, ip)) {
     switch (comp_prog.ptr[ip]) {
@@ -3784,6 +4236,16 @@ void comp_optimise() {
     case kwLET:
       ip = comp_optimise_let(ip);
       break;
+    case kwPRINT:
+      if (comp_prog.ptr[ip + 1] == kwTYPE_VAR && comp_is_eoc(ip + ADDRSZ + 2)) {
+        comp_prog.ptr[ip] = kwPRINT_VAR;
+      }
+      break;
+    case kwTYPE_VAR:
+      if (comp_is_var_opr_int(ip, 0)) {
+        comp_prog.ptr[ip] = kwTYPE_VAR_OPR_INT;
+      }
+      break;
     case kwTYPE_EOC:
       if (!opt_autolocal &&
           (comp_prog.ptr[ip + 1] == kwTYPE_EOC || comp_prog.ptr[ip + 1] == kwTYPE_LINE)) {
@@ -3794,6 +4256,13 @@ void comp_optimise() {
       break;
     }
   }
+  if (before) {
+    uint32_t *after = malloc(sizeof(uint32_t) * 256);
+    comp_count_opcodes(after);
+    comp_print_opcodes(before, after);
+    free(before);
+    free(after);
+  }
 }
 
 /*
@@ -3847,6 +4316,11 @@ void comp_init() {
   comp_varsize = comp_udpsize = GROWSIZE;
   comp_varcount = comp_labcount = comp_sp = comp_udpcount = 0;
 
+  comp_index_init(&comp_varindex);
+  comp_index_init(&comp_labindex);
+  comp_index_init(&comp_udpindex);
+  comp_init_keyword_index();
+
   bc_create(&comp_prog);
   bc_create(&comp_data);
 
@@ -3876,6 +4350,10 @@ void comp_close() {
   bc_destroy(&comp_prog);
   bc_destroy(&comp_data);
 
+  comp_index_free(&comp_varindex);
+  comp_index_free(&comp_labindex);
+  comp_index_free(&comp_udpindex);
+
   for (i = 0; i < comp_varcount; i++) {
     free(comp_vartable[i].name);
   }
@@ -3923,12 +4401,66 @@ void comp_close() {
   comp_reset_externals();
 }
 
+/*
+ * the files read by the compiler while tracking is on
+ */
+static struct {
+  char **files;
+  int count;
+  int tracking;
+} comp_depends;
+
+/*
+ * starts recording the files read by the compiler
+ */
+void comp_depends_begin() {
+  comp_depends_end();
+  comp_depends.tracking = 1;
+}
+
+/*
+ * stops recording and releases the list
+ */
+void comp_depends_end() {
+  for (int i = 0; i < comp_depends.count; i++) {
+    free(comp_depends.files[i]);
+  }
+  free(comp_depends.files);
+  comp_depends.files = NULL;
+  comp_depends.count = 0;
+  comp_depends.tracking = 0;
+}
+
+/*
+ * records a file which the compiled program depends on
+ */
+void comp_add_depend(const char *file) {
+  if (comp_depends.tracking) {
+    for (int i = 0; i < comp_depends.count; i++) {
+      if (strcmp(comp_depends.files[i], file) == 0) {
+        return;
+      }
+    }
+    comp_depends.files = realloc(comp_depends.files, (comp_depends.count + 1) * sizeof(char *));
+    comp_depends.files[comp_depends.count++] = strdup(file);
+  }
+}
+
+int comp_depend_count() {
+  return comp_depends.count;
+}
+
+const char *comp_depend(int index) {
+  return comp_depends.files[index];
+}
+
 /*
  * load a source file
  */
 char *comp_load(const char *file_name) {
   char *buf;
   strlcpy(comp_file_name, file_name, sizeof(comp_file_name));
+  comp_add_depend(file_name);
 #if defined(IMPL_DEV_READ)
   buf = dev_read(file_name);
 #else
@@ -4739,7 +5271,7 @@ int comp_pass1(const char *section, const char *text) {
  * setup export table
  */
 int comp_pass2_exports() {
-  int i, j;
+  int i;
 
   for (i = 0; i < comp_expcount; i++) {
     bid_t pid;
@@ -4756,18 +5288,12 @@ int comp_pass2_exports() {
       sym->vid = comp_udptable[pid].vid;
     } else {
       // look on variables
-      pid = -1;
-      for (j = 0; j < comp_varcount; j++) {
-        if (strcmp(comp_vartable[j].name, sym->symbol) == 0) {
-          pid = j;
-          break;
-        }
-      }
+      pid = comp_index_find(&comp_varindex, sym->symbol);
 
       if (pid != -1) {
         sym->type = stt_variable;
         sym->address = 0;
-        sym->vid = j;
+        sym->vid = pid;
       } else {
         sc_raise(MSG_EXP_SYM_NOT_FOUND, sym->symbol);
         return 0;
@@ -4791,7 +5317,9 @@ int comp_pass2() {
   } else if (comp_prog.size) {
     bc_add_code(&comp_prog, kwSTOP);
     comp_first_data_ip = comp_prog.count;
+    comp_pass2_index_create();
     comp_pass2_scan();
+    comp_pass2_index_free();
     comp_optimise();
   }
 
@@ -4955,10 +5483,17 @@ int comp_save_bin(byte_code bc) {
   }
   strcat(fname, comp_unit_flag ? ".sbu" : ".sbx");
 
+  // replace rather than rewrite the file, since running tasks and the unit
+  // cache may still map the previous version
+  remove(fname);
   int h = open(fname, O_BINARY | O_RDWR | O_TRUNC | O_CREAT, 0660);
   if (h != -1) {
     write(h, (char *)bc.code, bc.size);
     close(h);
+    if (comp_unit_flag) {
+      // the file may keep the same time and size as the cached version
+      unit_cache_invalidate(fname);
+    }
     if (!opt_quiet) {
       log_printf(MSG_BC_FILE_CREATED, fname);
     }
@@ -104,6 +104,24 @@ typedef struct {
   int symbol_index; /**< symbol index on symbol-table */
 } ext_func_node_t;
 
+/**
+ * @ingroup scan
+ * @typedef comp_index_t
+ *
+ * compiler's hash index from a name to its position in a table
+ */
+typedef struct {
+  const char *name; /**< the name held by the table entry */
+  uint32_t hash; /**< hash of the name */
+  bid_t id; /**< position in the table */
+} comp_index_slot_t;
+
+typedef struct {
+  comp_index_slot_t *slots; /**< open addressing slots, empty when name is NULL */
+  uint32_t size; /**< number of slots, a power of 2 */
+  uint32_t count; /**< number of slots in use */
+} comp_index_t;
+
 /**
  * @ingroup scan
  * @typedef comp_var_t
@@ -290,6 +308,16 @@ bid_t comp_is_proc(const char *name);
  */
 int comp_is_special_operator(const char *name);
 
+/**
+ * @ingroup scan
+ *
+ * returns the packed array type of DIM ... AS INTEGER|REAL
+ *
+ * @param text the source following AS
+ * @return V_PACK_INT, V_PACK_NUM or V_PACK_NONE
+ */
+int comp_array_type(const char *text);
+
 /**
  * @ingroup scan
  *
@@ -330,6 +358,43 @@ int comp_compile_buffer(const char *source);
  */
 char *comp_load(const char *sb_file_name);
 
+/**
+ * @ingroup scan
+ *
+ * starts recording the source files and units read by the compiler
+ */
+void comp_depends_begin(void);
+
+/**
+ * @ingroup scan
+ *
+ * stops recording and releases the recorded file names
+ */
+void comp_depends_end(void);
+
+/**
+ * @ingroup scan
+ *
+ * records a file which the compiled program depends on
+ *
+ * @param file the file name as it was opened
+ */
+void comp_add_depend(const char *file);
+
+/**
+ * @ingroup scan
+ *
+ * returns the number of recorded files
+ */
+int comp_depend_count(void);
+
+/**
+ * @ingroup scan
+ *
+ * returns the recorded file at the given index
+ */
+const char *comp_depend(int index);
+
 /**
  * @ingroup scan
  *
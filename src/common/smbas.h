@@ -99,12 +99,14 @@ typedef struct {
 
 #define OPT_CMD_SZ  1024
 #define OPT_MOD_SZ  1024
+#define OPT_CACHE_SZ 1024
 
 EXTERN byte opt_graphics; /**< command-line option: start in graphics mode   */
 EXTERN byte opt_quiet; /**< command-line option: quiet                       */
 EXTERN char opt_command[OPT_CMD_SZ]; /**< command-line parameters (COMMAND$) */
 EXTERN int opt_base; /**< OPTION BASE x                                      */
 EXTERN char opt_modpath[OPT_MOD_SZ]; /**< Modules path                       */
+EXTERN char opt_cachedir[OPT_CACHE_SZ]; /**< bytecode cache directory, "" = none */
 EXTERN int opt_verbose; /**< print some additional infos                     */
 EXTERN int opt_ide; /**< 0=no IDE, 1=IDE is linked, 2=IDE is external exe)   */
 EXTERN byte os_charset; /**< use charset encoding                            */
@@ -118,6 +120,8 @@ EXTERN byte opt_mute_audio; /**< whether to mute sounds                      */
 EXTERN byte opt_antialias; /**< OPTION ANTIALIAS OFF                         */
 EXTERN byte opt_autolocal; /**< OPTION AUTOLOCAL                             */
 EXTERN byte opt_trace_on; /**< initial value for the TRON command            */
+EXTERN int opt_event_budget; /**< max statements between event checks, 0=default */
+EXTERN int opt_stack_limit; /**< max executor stack nodes, 0=default          */
 
 #define IDE_NONE        0
 #define IDE_INTERNAL    1
@@ -129,6 +133,7 @@ EXTERN int gsb_last_error; /**< error code, 0 = no error,  < 0 = local messages
 EXTERN char gsb_last_file[OS_PATHNAME_SIZE + 1]; /**< source code file-name of the last error     */
 EXTERN char gsb_bas_dir[OS_PATHNAME_SIZE + 1]; /**< source code home dir     */
 EXTERN char gsb_last_errmsg[SB_ERRMSG_SIZE + 1]; /**< last error message     */
+EXTERN int v_share_lock; /**< non-zero while element pointers are held for writing, v_set() then copies */
 
 #include "common/units.h"
 #include "common/tasks.h"
@@ -154,6 +159,10 @@ EXTERN char gsb_last_errmsg[SB_ERRMSG_SIZE + 1]; /**< last error message     */
 #define eval_stk            ctask->sbe.exec.eval_stk
 #define eval_stk_size       ctask->sbe.exec.eval_stk_size
 #define eval_sp             ctask->sbe.exec.eval_esp
+#define prog_frames         ctask->sbe.exec.frames
+#define prog_frame_count    ctask->sbe.exec.frame_count
+#define prog_frame_blocks   ctask->sbe.exec.frame_blocks
+#define prog_loop_depth     ctask->sbe.exec.loop_depth
 #define prog_varcount       ctask->sbe.exec.varcount
 #define prog_labcount       ctask->sbe.exec.labcount
 #define prog_libcount       ctask->sbe.exec.libcount
@@ -164,6 +173,8 @@ EXTERN char gsb_last_errmsg[SB_ERRMSG_SIZE + 1]; /**< last error message     */
 #define prog_libtable       ctask->sbe.exec.libtable
 #define prog_symtable       ctask->sbe.exec.symtable
 #define prog_exptable       ctask->sbe.exec.exptable
+#define prog_fieldcache     ctask->sbe.exec.fieldcache
+#define prog_fieldmask      ctask->sbe.exec.fieldmask
 #define prog_timer          ctask->sbe.exec.timer
 #define comp_extfunctable   ctask->sbe.comp.extfunctable
 #define comp_extfunccount   ctask->sbe.comp.extfunccount
@@ -174,6 +185,7 @@ EXTERN char gsb_last_errmsg[SB_ERRMSG_SIZE + 1]; /**< last error message     */
 #define comp_vartable       ctask->sbe.comp.vartable
 #define comp_varcount       ctask->sbe.comp.varcount
 #define comp_varsize        ctask->sbe.comp.varsize
+#define comp_varindex       ctask->sbe.comp.varindex
 #define comp_imptable       ctask->sbe.comp.imptable
 #define comp_impcount       ctask->sbe.comp.imptable.count
 #define comp_exptable       ctask->sbe.comp.exptable
@@ -182,6 +194,7 @@ EXTERN char gsb_last_errmsg[SB_ERRMSG_SIZE + 1]; /**< last error message     */
 #define comp_libcount       ctask->sbe.comp.libtable.count
 #define comp_labtable       ctask->sbe.comp.labtable
 #define comp_labcount       ctask->sbe.comp.labtable.count
+#define comp_labindex       ctask->sbe.comp.labindex
 #define comp_bc_sec         ctask->sbe.comp.bc_sec
 #define comp_block_level    ctask->sbe.comp.block_level
 #define comp_block_id       ctask->sbe.comp.block_id
@@ -196,6 +209,7 @@ EXTERN char gsb_last_errmsg[SB_ERRMSG_SIZE + 1]; /**< last error message     */
 #define comp_udptable       ctask->sbe.comp.udptable
 #define comp_udpcount       ctask->sbe.comp.udpcount
 #define comp_udpsize        ctask->sbe.comp.udpsize
+#define comp_udpindex       ctask->sbe.comp.udpindex
 #define comp_use_global_vartable    ctask->sbe.comp.use_global_vartable
 #define comp_stack          ctask->sbe.comp.stack
 #define comp_sp             ctask->sbe.comp.stack.count
@@ -230,6 +244,13 @@ void brun_break(void);
  */
 void brun_stop(void);
 
+/**
+ * @ingroup exec
+ *
+ * check for events before the next statement, for use after blocking calls
+ */
+void brun_poll_events(void);
+
 /**
  * @ingroup exec
  *
@@ -86,8 +86,11 @@ extern "C" {
 #define SB_KEYWORD_SIZE     128
 #define SB_SOURCELINE_SIZE  65536 // compiler
 #define SB_TEXTLINE_SIZE    8192  // RTL
-#define SB_EXEC_STACK_SIZE  1024  // executor's stack size
+#define SB_EXEC_STACK_SIZE  1024  // executor's initial stack size
+#define SB_EXEC_STACK_LIMIT 1048576 // executor's default max stack size
 #define SB_EVAL_STACK_SIZE  16    // evaluation stack size
+#define SB_EXEC_LOOP_DEPTH  1024  // bc_loop() calls nested on the C stack
+#define SB_FRAME_BLOCK_BITS 8     // SUB/FUNC local variables per block (1 << bits)
 #define SB_KW_NONE_STR "Nil"
 
 // STD MACROS
@@ -120,6 +123,14 @@ typedef uint32_t bcip_t;
 #define CODESZ      OS_CODESZ
 #define BC_CTRLSZ   (ADDRSZ+ADDRSZ)
 
+// kwTYPE_VAR_OPR_INT: [addr] [EVPUSH] [INT][int] [EVPOP] [ADDOPR|CMPOPR][op]
+#define BC_VAR_OPR_INT_K    (ADDRSZ+3)
+#define BC_VAR_OPR_INT_OPR  (ADDRSZ+4+OS_INTSZ)
+#define BC_VAR_OPR_INT_LEN  (ADDRSZ+6+OS_INTSZ)
+
+// kwLET_APPEND: [VAR][addr] [CMPOPR][=] [VAR][addr] {[EVPUSH] operand [EVPOP] [ADDOPR][+]}
+#define BC_LET_APPEND_MAX   8
+
 #include "include/var.h"
 #include "common/str.h"
 
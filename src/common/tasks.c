@@ -158,7 +158,7 @@ int activate_task(int tid) {
  */
 int search_task(const char *task_name) {
   for (int i = 0; i < task_count; i++) {
-    if (strcmp(tasks[i].file, task_name) == 0) {
+    if (tasks[i].status != tsk_free && strcmp(tasks[i].file, task_name) == 0) {
       return i;
     }
   }
@@ -41,6 +41,10 @@ typedef struct {
   var_t *eval_stk; /**< eval's stack                                 */
   uint16_t eval_stk_size; /**< eval's stack size                     */
   uint16_t eval_esp; /**< Register ESP; eval's stack pointer          */
+  frame_var_t **frames; /**< blocks of SUB/FUNC local variables      */
+  uint32_t frame_count; /**< number of frame variables in use         */
+  uint32_t frame_blocks; /**< number of allocated frame blocks        */
+  uint32_t loop_depth; /**< bc_loop() calls nested on the C stack     */
 
   /*
    * Register R; no need
@@ -53,12 +57,14 @@ typedef struct {
   uint32_t libcount; /**< number of linked libraries                */
   uint32_t symcount; /**< number of linked symbols                  */
   uint32_t expcount; /**< number of exported symbols                */
+  uint32_t fieldmask; /**< field cache slots - 1                      */
 
   var_t **vartable; /**< The table of variables                      */
   lab_t *labtable; /**< The table of labels                          */
   bc_lib_rec_t *libtable; /**< import-libraries table                */
   bc_symbol_rec_t *symtable; /**< import-symbols table               */
   unit_sym_t *exptable; /**< export-symbols table                    */
+  field_cache_t *fieldcache; /**< kwTYPE_UDS_EL resolved fields       */
   timer_s *timer;  /** timer linked list                             */
 } task_executor;
 
@@ -105,14 +111,17 @@ typedef struct {
   comp_var_t *vartable;
   bid_t varcount;
   bid_t varsize;
+  comp_index_t varindex;
 
   // label table
   comp_label_table_t labtable;
+  comp_index_t labindex;
 
   // user defined proc/func table
   comp_udp_t *udptable;
   bid_t udpcount;
   bid_t udpsize;
+  comp_index_t udpindex;
 
   // pass2 stack
   comp_pass_node_table_t stack;
@@ -135,6 +144,7 @@ typedef struct {
   char errmsg[SB_ERRMSG_SIZE + 1];
   char file[OS_PATHNAME_SIZE + 1];  /**< The program file name (task name) */
   byte *bytecode; /**< BC's memory handle                          */
+  size_t bc_mapsize; /**< size of the BC mapping, 0 when allocated  */
   int bc_type; /**< BC type (1=executable, 2=unit)                 */
   int has_sysvars; /**< true if the task has system-variables      */
 
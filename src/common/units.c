@@ -15,10 +15,147 @@
 #include "common/scan.h"
 #include "common/units.h"
 
+#if defined(_UnixOS) && !defined(__MINGW32__)
+#include <sys/mman.h>
+#define UNIT_MMAP
+#endif
+
 // units table
 static unit_t *units;
 static int unit_count = 0;
 
+/**
+ * the contents of a compiled unit file, kept between runs while the file
+ * keeps the same modification time and size. the contents are a read-only
+ * mapping of the file where available, otherwise an allocated copy
+ */
+typedef struct {
+  char name[OS_PATHNAME_SIZE + 1];
+  time_t mtime;
+  uint32_t size;
+  size_t mapsize;
+  byte *image;
+} unit_image_t;
+
+// process-wide compiled unit cache, not cleared by unit_mgr_close()
+static unit_image_t *unit_images;
+static int unit_image_count = 0;
+
+static unit_image_t *unit_cache_find(const char *file) {
+  for (int i = 0; i < unit_image_count; i++) {
+    if (strcmp(unit_images[i].name, file) == 0) {
+      return &unit_images[i];
+    }
+  }
+  return NULL;
+}
+
+static void unit_cache_free(unit_image_t *entry) {
+#if defined(UNIT_MMAP)
+  if (entry->mapsize) {
+    munmap(entry->image, entry->mapsize);
+  } else {
+    free(entry->image);
+  }
+#else
+  free(entry->image);
+#endif
+}
+
+/**
+ * returns the cached contents of the given .sbu file, reading the file
+ * when it isn't cached or has changed since it was cached
+ */
+const byte *unit_cache_get(const char *file, uint32_t *size) {
+  struct stat st;
+  if (stat(file, &st) != 0 || st.st_size == 0) {
+    unit_cache_invalidate(file);
+    return NULL;
+  }
+
+  unit_image_t *entry = unit_cache_find(file);
+  if (entry != NULL && entry->mtime == st.st_mtime && entry->size == st.st_size) {
+    *size = entry->size;
+    return entry->image;
+  }
+
+  byte *image = NULL;
+  size_t mapsize = 0;
+  int h = open(file, O_RDONLY | O_BINARY);
+  if (h != -1) {
+#if defined(UNIT_MMAP)
+    image = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, h, 0);
+    if (image == MAP_FAILED) {
+      image = NULL;
+    } else {
+      mapsize = st.st_size;
+    }
+#endif
+    if (image == NULL) {
+      image = malloc(st.st_size + 4);
+      if (read(h, image, st.st_size) != st.st_size) {
+        free(image);
+        image = NULL;
+      }
+    }
+    close(h);
+  }
+  if (image == NULL) {
+    unit_cache_invalidate(file);
+    return NULL;
+  }
+
+  if (entry == NULL) {
+    unit_images = realloc(unit_images, (unit_image_count + 1) * sizeof(unit_image_t));
+    entry = &unit_images[unit_image_count++];
+    strlcpy(entry->name, file, sizeof(entry->name));
+  } else {
+    unit_cache_free(entry);
+  }
+  entry->mtime = st.st_mtime;
+  entry->size = st.st_size;
+  entry->mapsize = mapsize;
+  entry->image = image;
+  *size = entry->size;
+  return image;
+}
+
+/**
+ * opens the given .sbu file for reading when it still has the modification
+ * time and size of its cached contents, otherwise returns -1
+ */
+int unit_cache_open(const char *file) {
+  unit_image_t *entry = unit_cache_find(file);
+  int h = entry != NULL ? open(file, O_RDONLY | O_BINARY) : -1;
+  if (h != -1) {
+    struct stat st;
+    if (fstat(h, &st) != 0 || entry->mtime != st.st_mtime || entry->size != st.st_size) {
+      close(h);
+      h = -1;
+    }
+  }
+  return h;
+}
+
+/**
+ * removes the given file from the unit cache, or every file when NULL
+ */
+void unit_cache_invalidate(const char *file) {
+  int j = 0;
+  for (int i = 0; i < unit_image_count; i++) {
+    if (file == NULL || strcmp(unit_images[i].name, file) == 0) {
+      unit_cache_free(&unit_images[i]);
+    } else {
+      unit_images[j++] = unit_images[i];
+    }
+  }
+  unit_image_count = j;
+  if (unit_image_count == 0) {
+    free(unit_images);
+    unit_images = NULL;
+  }
+}
+
 /**
  *   initialization
  */
@@ -98,7 +235,6 @@ int find_unit(const char *name, char *file) {
  * @return the unit handle or -1 on error
  */
 int open_unit(const char *file, const char *alias) {
-  int h;
   unit_t u;
   int uid = -1;
 
@@ -145,26 +281,31 @@ int open_unit(const char *file, const char *alias) {
   }
 
   // open unit
-  h = open(unitname, O_RDWR | O_BINARY);
-  if (h == -1) {
+  uint32_t size;
+  const byte *image = unit_cache_get(unitname, &size);
+  if (image == NULL || size < sizeof(unit_file_t)) {
     return -1;
   }
 
   // read file header
-  int nread = read(h, &u.hdr, sizeof(unit_file_t));
-  if (nread != sizeof(unit_file_t) ||
-      u.hdr.version != SB_DWORD_VER ||
-      memcmp(&u.hdr.sign, "SBUn", 4) != 0) {
-    close(h);
+  memcpy(&u.hdr, image, sizeof(unit_file_t));
+  if (u.hdr.version != SB_DWORD_VER ||
+      memcmp(&u.hdr.sign, "SBUn", 4) != 0 ||
+      u.hdr.sym_count < 0 ||
+      size < sizeof(unit_file_t) + u.hdr.sym_count * sizeof(unit_sym_t)) {
     return -1;
   }
 
   // load symbol-table
   if (u.hdr.sym_count) {
     u.symbols = (unit_sym_t *)malloc(u.hdr.sym_count * sizeof(unit_sym_t));
-    read(h, u.symbols, u.hdr.sym_count * sizeof(unit_sym_t));
+    memcpy(u.symbols, image + sizeof(unit_file_t), u.hdr.sym_count * sizeof(unit_sym_t));
   }
 
+  // the importing program depends on the unit's source and symbols
+  comp_add_depend(bas_file);
+  comp_add_depend(unitname);
+
   // setup the rest
   strcpy(u.name, unitname);
   strcpy(u.hdr.base, alias);
@@ -182,9 +323,6 @@ int open_unit(const char *file, const char *alias) {
 
   // copy unit's data
   memcpy(&units[uid], &u, sizeof(unit_t));
-
-  // cleanup
-  close(h);
   return uid;
 }
 
@@ -303,8 +441,8 @@ int unit_exec(int lib_id, int index, var_t *ret) {
     if (udf_rv.type != kwTYPE_RET) {
       err_stackmess();
     } else {
-      v_set(ret, udf_rv.x.vdvar.vptr);
-      v_free(udf_rv.x.vdvar.vptr);  // free ret-var
+      v_move(ret, udf_rv.x.vdvar.vptr);
+      // no free after v_move
       v_detach(udf_rv.x.vdvar.vptr);
     }
 
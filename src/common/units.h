@@ -97,6 +97,38 @@ void unit_mgr_init();
  */
 void unit_mgr_close();
 
+/**
+ * @ingroup exec
+ *
+ * returns the contents of a compiled unit file. the contents are kept
+ * between runs, mapped read-only where the platform allows, and only read
+ * again once the file's modification time or size changes
+ *
+ * @param file the .sbu file name
+ * @param size receives the size of the contents
+ * @return the contents owned by the cache, or NULL when the file can't be read
+ */
+const byte *unit_cache_get(const char *file, uint32_t *size);
+
+/**
+ * @ingroup exec
+ *
+ * opens a compiled unit file that still matches its cached contents
+ *
+ * @param file the .sbu file name
+ * @return the file handle, or -1 when the file isn't cached or has changed
+ */
+int unit_cache_open(const char *file);
+
+/**
+ * @ingroup exec
+ *
+ * drops a compiled unit file from the cache
+ *
+ * @param file the .sbu file name, or NULL to drop every file
+ */
+void unit_cache_invalidate(const char *file);
+
 /**
  * @ingroup exec
  *
@@ -11,36 +11,69 @@
 #include "common/sberr.h"
 
 #define INT_STR_LEN 64
-#define VAR_POOL_SIZE 8192
+#define VAR_SLAB_SIZE 4096
+#define STR_INIT_SIZE 16
 
-var_t var_pool[VAR_POOL_SIZE];
-var_t *var_pool_head;
+// a chunk of variables handed out by v_new()
+typedef struct var_slab_s {
+  struct var_slab_s *next;
+  var_t vars[VAR_SLAB_SIZE];
+} var_slab_t;
+
+// the variable pool. slabs are added as required and released by v_init_pool()
+static struct {
+  // the slabs, newest first
+  var_slab_t *slabs;
+  // variables returned by v_pool_free()
+  var_t *free_list;
+  // the number of variables taken from the newest slab
+  uint32_t slab_used;
+  var_pool_stats_t stats;
+} var_pool;
 
 void v_init_pool() {
-  for (uint32_t i = 0; i < VAR_POOL_SIZE; i++) {
-    v_init(&var_pool[i]);
-    var_pool[i].pooled = 1;
-    if (i + 1 < VAR_POOL_SIZE) {
-      var_pool[i].v.pool_next = &var_pool[i + 1];
-    } else {
-      var_pool[i].v.pool_next = NULL;
-    }
+  var_slab_t *slab = var_pool.slabs;
+  while (slab != NULL) {
+    var_slab_t *next = slab->next;
+    free(slab);
+    slab = next;
   }
-  var_pool_head = &var_pool[0];
+  memset(&var_pool, 0, sizeof(var_pool));
+}
+
+void v_pool_stats(var_pool_stats_t *stats) {
+  *stats = var_pool.stats;
 }
 
 /*
  * creates and returns a new variable
  */
 var_t *v_new() {
-  var_t *result = var_pool_head;
+  var_t *result = var_pool.free_list;
   if (result != NULL) {
     // remove an item from the free-list
-    var_pool_head = result->v.pool_next;
+    var_pool.free_list = result->v.pool_next;
   } else {
-    // pool exhausted
-    result = (var_t *)malloc(sizeof(var_t));
-    result->pooled = 0;
+    if (var_pool.slabs == NULL || var_pool.slab_used == VAR_SLAB_SIZE) {
+      var_slab_t *slab = (var_slab_t *)malloc(sizeof(var_slab_t));
+      if (slab != NULL) {
+        slab->next = var_pool.slabs;
+        var_pool.slabs = slab;
+        var_pool.slab_used = 0;
+        var_pool.stats.slabs++;
+      }
+    }
+    if (var_pool.slabs != NULL && var_pool.slab_used < VAR_SLAB_SIZE) {
+      result = &var_pool.slabs->vars[var_pool.slab_used++];
+      result->pooled = 1;
+    } else {
+      // out of memory for another slab
+      result = (var_t *)malloc(sizeof(var_t));
+      result->pooled = 0;
+    }
+  }
+  if (result->pooled && ++var_pool.stats.count > var_pool.stats.high_water) {
+    var_pool.stats.high_water = var_pool.stats.count;
   }
   v_init(result);
   return result;
@@ -48,8 +81,27 @@ var_t *v_new() {
 
 void v_pool_free(var_t *var) {
   // insert back into the free list
-  var->v.pool_next = var_pool_head;
-  var_pool_head = var;
+  var->v.pool_next = var_pool.free_list;
+  var_pool.free_list = var;
+  var_pool.stats.count--;
+}
+
+void *v_shared_new(size_t size) {
+  var_shared_t *hdr = (var_shared_t *)calloc(1, sizeof(var_shared_t) + size);
+  if (hdr == NULL) {
+    return NULL;
+  }
+  hdr->refs = 1;
+  return hdr + 1;
+}
+
+void *v_shared_resize(void *data, size_t size) {
+  var_shared_t *hdr = (var_shared_t *)realloc(v_shared_hdr(data), sizeof(var_shared_t) + size);
+  return hdr == NULL ? NULL : hdr + 1;
+}
+
+void v_shared_free(void *data) {
+  free(v_shared_hdr(data));
 }
 
 uint32_t v_get_capacity(uint32_t size) {
@@ -61,10 +113,15 @@ void v_alloc_capacity(var_t *var, uint32_t size) {
   uint32_t capacity = v_get_capacity(size);
   v_capacity(var) = capacity;
   v_asize(var) = size;
-  v_data(var) = (var_t *)malloc(sizeof(var_t) * capacity);
+  if (v_is_packed(var)) {
+    // zero is all bits clear for both var_int_t and var_num_t
+    v_data(var) = (var_t *)v_shared_new(capacity * OS_INTSZ);
+  } else {
+    v_data(var) = (var_t *)v_shared_new(sizeof(var_t) * capacity);
+  }
   if (!v_data(var)) {
     err_memory();
-  } else {
+  } else if (!v_is_packed(var)) {
     for (uint32_t i = 0; i < capacity; i++) {
       var_t *e = v_elem(var, i);
       e->pooled = 0;
@@ -78,7 +135,7 @@ void v_init_array(var_t *var) {
   v_capacity(var) = 0;
   v_asize(var) = 0;
   v_data(var) = NULL;
-  v_maxdim(var) = 1;
+  v_set_maxdim(var, 1);
   v_ubound(var, 0) = opt_base;
   v_lbound(var, 0) = opt_base;
 }
@@ -89,18 +146,26 @@ void v_new_array(var_t *var, uint32_t size) {
   v_alloc_capacity(var, size);
 }
 
+// create an array of numbers stored without var_t wrappers
+void v_new_packed_array(var_t *var, uint32_t size, uint8_t pack_type) {
+  var->type = V_ARRAY;
+  var->pack_type = pack_type;
+  v_alloc_capacity(var, size);
+}
+
 void v_set_array1_size(var_t *var, uint32_t size) {
   v_asize(var) = size;
-  v_maxdim(var) = 1;
+  v_set_maxdim(var, 1);
   v_ubound(var, 0) = v_lbound(var, 0) + (size - 1);
 }
 
 void v_copy_array(var_t *dest, const var_t *src) {
   dest->type = V_ARRAY;
+  dest->pack_type = src->pack_type;
   v_alloc_capacity(dest, v_asize(src));
 
   // copy dimensions
-  v_maxdim(dest) = v_maxdim(src);
+  v_set_maxdim(dest, v_maxdim(src));
   for (int i = 0; i < v_maxdim(src); i++) {
     v_ubound(dest, i) = v_ubound(src, i);
     v_lbound(dest, i) = v_lbound(src, i);
@@ -108,29 +173,218 @@ void v_copy_array(var_t *dest, const var_t *src) {
 
   // copy each element
   uint32_t v_size = v_asize(src);
-  for (uint32_t i = 0; i < v_size; i++) {
-    var_t *dest_vp = v_elem(dest, i);
-    v_init(dest_vp);
-    v_set(dest_vp, v_elem(src, i));
+  if (v_is_packed(src)) {
+    memcpy(v_data(dest), v_data(src), v_size * OS_INTSZ);
+  } else {
+    for (uint32_t i = 0; i < v_size; i++) {
+      var_t *dest_vp = &v_data(dest)[i];
+      v_init(dest_vp);
+      v_set(dest_vp, &v_data(src)[i]);
+    }
   }
 }
 
+// share the storage of src with dest
+void v_share_array(var_t *dest, const var_t *src) {
+  memcpy(&dest->v.a, &src->v.a, sizeof(src->v.a));
+  v_maxdim(dest) = v_maxdim(src);
+  dest->pack_type = src->pack_type;
+  v_shared_hdr(v_data(src))->refs++;
+  if (v_maxdim(src) > 1) {
+    // the bounds are not shared
+    dest->v.a.dim.dims = (var_dim_t *)malloc(sizeof(var_dim_t));
+    if (!dest->v.a.dim.dims) {
+      v_maxdim(dest) = 1;
+      err_memory();
+    } else {
+      memcpy(dest->v.a.dim.dims, src->v.a.dim.dims, sizeof(var_dim_t));
+    }
+  }
+}
+
+void v_set_maxdim(var_t *var, int maxdim) {
+  if (maxdim > 1 && v_maxdim(var) <= 1) {
+    var_dim_t *dims = (var_dim_t *)malloc(sizeof(var_dim_t));
+    if (!dims) {
+      err_memory();
+      return;
+    }
+    dims->lbound[0] = var->v.a.dim.bound[0];
+    dims->ubound[0] = var->v.a.dim.bound[1];
+    var->v.a.dim.dims = dims;
+  } else if (maxdim <= 1 && v_maxdim(var) > 1) {
+    var_dim_t *dims = var->v.a.dim.dims;
+    var->v.a.dim.bound[0] = dims->lbound[0];
+    var->v.a.dim.bound[1] = dims->ubound[0];
+    free(dims);
+  }
+  v_maxdim(var) = maxdim;
+}
+
 void v_array_free(var_t *var) {
   uint32_t v_size = v_capacity(var);
   if (v_size && v_data(var)) {
-    for (uint32_t i = 0; i < v_size; i++) {
-      v_free(v_elem(var, i));
+    if (v_shared_hdr(v_data(var))->refs > 1) {
+      // still in use by another variable
+      v_shared_hdr(v_data(var))->refs--;
+    } else {
+      if (!v_is_packed(var)) {
+        for (uint32_t i = 0; i < v_size; i++) {
+          v_free(&v_data(var)[i]);
+        }
+      }
+      v_shared_free(v_data(var));
+    }
+  }
+}
+
+void v_array_unshare(var_t *var) {
+  var_t *shared = v_data(var);
+  uint32_t capacity = v_capacity(var);
+  if (capacity && shared && v_shared_hdr(shared)->refs > 1) {
+    uint32_t size = v_asize(var);
+    var_t *data;
+    if (v_is_packed(var)) {
+      data = (var_t *)v_shared_new(capacity * OS_INTSZ);
+      if (data) {
+        memcpy(data, shared, size * OS_INTSZ);
+      }
+    } else {
+      data = (var_t *)v_shared_new(sizeof(var_t) * capacity);
+      for (uint32_t i = 0; data && i < capacity; i++) {
+        var_t *e = &data[i];
+        e->pooled = 0;
+        v_init(e);
+        if (i < size) {
+          v_set(e, &shared[i]);
+        }
+      }
+    }
+    if (!data) {
+      err_memory();
+    } else {
+      v_shared_hdr(shared)->refs--;
+      v_data(var) = data;
+    }
+  }
+}
+
+var_t *v_array_elems(var_t *var) {
+  if (v_is_packed(var)) {
+    return v_array_unpack(var);
+  }
+  v_array_unshare(var);
+  return v_data(var);
+}
+
+/**
+ * returns whether a V_NUM value is outside the range of a V_PACK_INT element
+ */
+static inline int v_int_overflow(const var_t *value) {
+  return value->type == V_NUM && !(value->v.n >= -0x1p63 && value->v.n < 0x1p63);
+}
+
+void v_array_pack(var_t *var, uint8_t pack_type) {
+  if (pack_type == V_PACK_NONE) {
+    v_array_unpack(var);
+  } else if (var->pack_type != pack_type) {
+    uint32_t size = v_asize(var);
+    uint32_t capacity = v_capacity(var);
+    for (uint32_t i = 0; i < size && capacity && pack_type == V_PACK_INT; i++) {
+      var_t tmp;
+      if (v_int_overflow(v_array_get(var, i, &tmp))) {
+        // keep generic elements rather than wrap the value
+        v_array_unpack(var);
+        return;
+      }
+    }
+    if (capacity && v_data(var)) {
+      void *data = v_shared_new(capacity * OS_INTSZ);
+      if (!data) {
+        err_memory();
+        return;
+      }
+      for (uint32_t i = 0; i < size; i++) {
+        var_t tmp;
+        var_t *elem = v_array_get(var, i, &tmp);
+        if (pack_type == V_PACK_INT) {
+          ((var_int_t *)data)[i] = v_getint(elem);
+        } else {
+          ((var_num_t *)data)[i] = v_getreal(elem);
+        }
+      }
+      v_array_free(var);
+      v_data(var) = (var_t *)data;
+    }
+    var->pack_type = pack_type;
+  } else {
+    v_array_unshare(var);
+  }
+}
+
+var_t *v_array_unpack(var_t *var) {
+  uint32_t capacity = v_capacity(var);
+  if (v_is_packed(var) && capacity && v_data(var)) {
+    uint32_t size = v_asize(var);
+    var_t *data = (var_t *)v_shared_new(sizeof(var_t) * capacity);
+    if (!data) {
+      err_memory();
+      return v_data(var);
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+      var_t *e = &data[i];
+      e->pooled = 0;
+      v_init(e);
+      if (i < size) {
+        if (var->pack_type == V_PACK_INT) {
+          e->v.i = v_idata(var)[i];
+        } else {
+          e->type = V_NUM;
+          e->v.n = v_ndata(var)[i];
+        }
+      }
     }
-    free(var->v.a.data);
+    v_array_free(var);
+    v_data(var) = data;
+  }
+  var->pack_type = V_PACK_NONE;
+  return v_data(var);
+}
+
+void v_array_set(var_t *var, uint32_t i, var_t *value) {
+  v_array_unshare(var);
+  if (var->pack_type == V_PACK_INT && (value->type == V_INT || value->type == V_NUM) &&
+      !v_int_overflow(value)) {
+    v_idata(var)[i] = v_getint(value);
+  } else if (var->pack_type == V_PACK_NUM && (value->type == V_INT || value->type == V_NUM)) {
+    v_ndata(var)[i] = v_getreal(value);
+  } else {
+    // other values unpack the array, as does a real outside the V_PACK_INT range
+    v_move(v_elem(var, i), value);
   }
 }
 
 void v_init_str(var_t *var, int length) {
   var->type = V_STR;
-  var->v.p.ptr = malloc(length + 1);
-  var->v.p.ptr[0] = '\0';
+  if (length < V_STR_INLINE_SIZE) {
+    var->v.p.buf[0] = '\0';
+    var->v.p.owner = V_STR_INLINE;
+  } else {
+    var->v.p.ptr = malloc(length + 1);
+    var->v.p.ptr[0] = '\0';
+    var->v.p.owner = V_STR_OWNER;
+  }
   var->v.p.length = length + 1;
-  var->v.p.owner = 1;
+}
+
+void v_strheap(var_t *var) {
+  if (v_is_type(var, V_STR) && var->v.p.owner == V_STR_INLINE) {
+    uint32_t length = var->v.p.length;
+    char *ptr = malloc(length > V_STR_INLINE_SIZE ? length : V_STR_INLINE_SIZE);
+    memcpy(ptr, var->v.p.buf, V_STR_INLINE_SIZE);
+    var->v.p.ptr = ptr;
+    var->v.p.owner = V_STR_OWNER;
+  }
 }
 
 void v_move_str(var_t *var, char *str) {
@@ -169,7 +423,7 @@ int v_strlen(const var_t *v) {
   int result;
   if (v->type == V_STR) {
     result = v->v.p.length;
-    if (result && v->v.p.ptr[result - 1] == '\0') {
+    if (result && v_strptr(v)[result - 1] == '\0') {
       result--;
     }
   } else {
@@ -217,29 +471,44 @@ void v_resize_array(var_t *v, uint32_t size) {
   } else if (size == v_asize(v)) {
     // already at target size
   } else if (size == 0) {
+    uint8_t pack_type = v->pack_type;
     v_free(v);
     v_init_array(v);
     v->type = V_ARRAY;
+    v->pack_type = pack_type;
   } else if (size < v_asize(v)) {
     // resize down. free discarded elements
+    v_array_unshare(v);
     uint32_t v_size = v_asize(v);
-    for (uint32_t i = size; i < v_size; i++) {
+    for (uint32_t i = size; i < v_size && !v_is_packed(v); i++) {
       v_free(v_elem(v, i));
     }
     v_set_array1_size(v, size);
   } else if (size <= v_capacity(v)) {
     // use existing capacity
+    v_array_unshare(v);
+    if (v_is_packed(v)) {
+      memset(v_idata(v) + v_asize(v), 0, (size - v_asize(v)) * OS_INTSZ);
+    }
     v_set_array1_size(v, size);
   } else {
     // insufficient capacity
     uint32_t prev_size = v_asize(v);
+    v_array_unshare(v);
     if (prev_size == 0) {
+      v_array_free(v);
       v_alloc_capacity(v, size);
+    } else if (v_is_packed(v)) {
+      // resize & copy
+      uint32_t capacity = v_get_capacity(size);
+      v_capacity(v) = capacity;
+      v_data(v) = (var_t *)v_shared_resize(v_data(v), OS_INTSZ * capacity);
+      memset(v_idata(v) + prev_size, 0, (capacity - prev_size) * OS_INTSZ);
     } else if (prev_size < size) {
       // resize & copy
       uint32_t capacity = v_get_capacity(size);
       v_capacity(v) = capacity;
-      v_data(v) = (var_t *)realloc(v_data(v), sizeof(var_t) * capacity);
+      v_data(v) = (var_t *)v_shared_resize(v_data(v), sizeof(var_t) * capacity);
       for (uint32_t i = prev_size; i < capacity; i++) {
         var_t *e = v_elem(v, i);
         e->pooled = 0;
@@ -248,7 +517,7 @@ void v_resize_array(var_t *v, uint32_t size) {
     }
 
     // init vars
-    for (uint32_t i = prev_size; i < size; i++) {
+    for (uint32_t i = prev_size; i < size && !v_is_packed(v); i++) {
       v_init(v_elem(v, i));
     }
 
@@ -262,7 +531,7 @@ void v_resize_array(var_t *v, uint32_t size) {
 void v_tomatrix(var_t *v, int r, int c) {
   v_free(v);
   v_new_array(v, r * c);
-  v_maxdim(v) = 2;
+  v_set_maxdim(v, 2);
   v_lbound(v, 0) = v_lbound(v, 1) = opt_base;
   v_ubound(v, 0) = opt_base + (r - 1);
   v_ubound(v, 1) = opt_base + (c - 1);
@@ -276,7 +545,6 @@ void v_toarray1(var_t *v, uint32_t r) {
   v->type = V_ARRAY;
   if (r > 0) {
     v_new_array(v, r);
-    v_maxdim(v) = 1;
     v_lbound(v, 0) = opt_base;
     v_ubound(v, 0) = opt_base + (r - 1);
   } else {
@@ -334,10 +602,10 @@ int v_compare(var_t *a, var_t *b) {
     }
   }
   if ((a->type == V_STR) && (b->type == V_STR)) {
-    return strcmp(a->v.p.ptr, b->v.p.ptr);
+    return strcmp(v_strptr(a), v_strptr(b));
   }
   if ((a->type == V_STR) && (b->type == V_NUM)) {
-    if (a->v.p.ptr[0] == '\0' || is_number(a->v.p.ptr)) {
+    if (v_strptr(a)[0] == '\0' || is_number(v_strptr(a))) {
       // compare nums
       dt = v_getval(a);
       return (dt < b->v.n) ? -1 : ((dt == b->v.n) ? 0 : 1);
@@ -345,7 +613,7 @@ int v_compare(var_t *a, var_t *b) {
     return 1;
   }
   if ((a->type == V_NUM) && (b->type == V_STR)) {
-    if (b->v.p.ptr[0] == '\0' || is_number(b->v.p.ptr)) {
+    if (v_strptr(b)[0] == '\0' || is_number(v_strptr(b))) {
       // compare nums
       dt = v_getval(b);
       return (dt < a->v.n) ? 1 : ((dt == a->v.n) ? 0 : -1);
@@ -353,7 +621,7 @@ int v_compare(var_t *a, var_t *b) {
     return - 1;
   }
   if ((a->type == V_STR) && (b->type == V_INT)) {
-    if (a->v.p.ptr[0] == '\0' || is_number(a->v.p.ptr)) {
+    if (v_strptr(a)[0] == '\0' || is_number(v_strptr(a))) {
       // compare nums
       di = v_igetval(a);
       return (di < b->v.i) ? -1 : ((di == b->v.i) ? 0 : 1);
@@ -361,7 +629,7 @@ int v_compare(var_t *a, var_t *b) {
     return 1;
   }
   if ((a->type == V_INT) && (b->type == V_STR)) {
-    if (b->v.p.ptr[0] == '\0' || is_number(b->v.p.ptr)) {
+    if (v_strptr(b)[0] == '\0' || is_number(v_strptr(b))) {
       // compare nums
       di = v_igetval(b);
       return (di < a->v.i) ? 1 : ((di == a->v.i) ? 0 : -1);
@@ -377,8 +645,9 @@ int v_compare(var_t *a, var_t *b) {
     }
     // check every element
     for (uint32_t i = 0; i < v_asize(a); i++) {
-      var_t *ea = v_elem(a, i);
-      var_t *eb = v_elem(b, i);
+      var_t ta, tb;
+      var_t *ea = v_array_get(a, i, &ta);
+      var_t *eb = v_array_get(b, i, &tb);
       int ci = v_compare(ea, eb);
       if (ci != 0) {
         return ci;
@@ -409,10 +678,12 @@ void v_add(var_t *result, var_t *a, var_t *b) {
   char tmpsb[INT_STR_LEN];
 
   if (a->type == V_STR && b->type == V_STR) {
-    int length = strlen(a->v.p.ptr) + strlen(b->v.p.ptr);
-    v_init_str(result, length);
-    strcpy(result->v.p.ptr, a->v.p.ptr);
-    strcat(result->v.p.ptr, b->v.p.ptr);
+    int a_len = v_strlen(a);
+    int b_len = v_strlen(b);
+    v_init_str(result, a_len + b_len);
+    memcpy(v_strptr(result), v_strptr(a), a_len);
+    memcpy(v_strptr(result) + a_len, v_strptr(b), b_len);
+    v_strptr(result)[a_len + b_len] = '\0';
     return;
   } else if (a->type == V_INT && b->type == V_INT) {
     result->type = V_INT;
@@ -431,7 +702,7 @@ void v_add(var_t *result, var_t *a, var_t *b) {
     result->v.n = a->v.i + b->v.n;
     return;
   } else if (a->type == V_STR && (b->type == V_INT || b->type == V_NUM)) {
-    if (is_number(a->v.p.ptr)) {
+    if (is_number(v_strptr(a))) {
       result->type = V_NUM;
       if (b->type == V_INT) {
         result->v.n = b->v.i + v_getval(a);
@@ -439,18 +710,19 @@ void v_add(var_t *result, var_t *a, var_t *b) {
         result->v.n = b->v.n + v_getval(a);
       }
     } else {
-      v_init_str(result, strlen(a->v.p.ptr) + INT_STR_LEN);
-      strcpy(result->v.p.ptr, a->v.p.ptr);
       if (b->type == V_INT) {
         ltostr(b->v.i, tmpsb);
       } else {
         ftostr(b->v.n, tmpsb);
       }
-      strcat(result->v.p.ptr, tmpsb);
-      result->v.p.length = strlen(result->v.p.ptr) + 1;
+      int a_len = v_strlen(a);
+      int b_len = strlen(tmpsb);
+      v_init_str(result, a_len + b_len);
+      memcpy(v_strptr(result), v_strptr(a), a_len);
+      memcpy(v_strptr(result) + a_len, tmpsb, b_len + 1);
     }
   } else if ((a->type == V_INT || a->type == V_NUM) && b->type == V_STR) {
-    if (is_number(b->v.p.ptr)) {
+    if (is_number(v_strptr(b))) {
       result->type = V_NUM;
       if (a->type == V_INT) {
         result->v.n = a->v.i + v_getval(b);
@@ -458,15 +730,17 @@ void v_add(var_t *result, var_t *a, var_t *b) {
         result->v.n = a->v.n + v_getval(b);
       }
     } else {
-      v_init_str(result, strlen(b->v.p.ptr) + INT_STR_LEN);
       if (a->type == V_INT) {
         ltostr(a->v.i, tmpsb);
       } else {
         ftostr(a->v.n, tmpsb);
       }
-      strcpy(result->v.p.ptr, tmpsb);
-      strcat(result->v.p.ptr, b->v.p.ptr);
-      result->v.p.length = strlen(result->v.p.ptr) + 1;
+      int a_len = strlen(tmpsb);
+      int b_len = v_strlen(b);
+      v_init_str(result, a_len + b_len);
+      memcpy(v_strptr(result), tmpsb, a_len);
+      memcpy(v_strptr(result) + a_len, v_strptr(b), b_len);
+      v_strptr(result)[a_len + b_len] = '\0';
     }
   } else if (b->type == V_MAP) {
     char *map = map_to_str(b);
@@ -476,6 +750,29 @@ void v_add(var_t *result, var_t *a, var_t *b) {
   }
 }
 
+/*
+ * a = a + b
+ */
+void v_append(var_t *a, var_t *b) {
+  char tmpsb[INT_STR_LEN];
+
+  if (a->type == V_STR && b->type == V_STR) {
+    v_strncat(a, v_strptr(b), v_strlen(b));
+  } else if (a->type == V_STR && (b->type == V_INT || b->type == V_NUM) && !is_number(v_strptr(a))) {
+    if (b->type == V_INT) {
+      ltostr(b->v.i, tmpsb);
+    } else {
+      ftostr(b->v.n, tmpsb);
+    }
+    v_strcat(a, tmpsb);
+  } else {
+    var_t result;
+    v_init(&result);
+    v_add(&result, a, b);
+    v_move(a, &result);
+  }
+}
+
 /*
  * assign (dest = src)
  */
@@ -492,22 +789,25 @@ void v_set(var_t *dest, const var_t *src) {
     dest->v.n = src->v.n;
     break;
   case V_STR:
-    if (src->v.p.owner) {
-      dest->v.p.length = v_strlen(src) + 1;
-      dest->v.p.ptr = (char *)malloc(dest->v.p.length);
-      dest->v.p.owner = 1;
-      strcpy(dest->v.p.ptr, src->v.p.ptr);
+    if (src->v.p.owner != V_STR_BORROWED) {
+      int length = v_strlen(src);
+      v_init_str(dest, length);
+      memcpy(v_strptr(dest), v_strptr(src), length);
+      v_strptr(dest)[length] = '\0';
     } else {
       dest->v.p.length = src->v.p.length;
       dest->v.p.ptr = src->v.p.ptr;
-      dest->v.p.owner = 0;
+      dest->v.p.owner = V_STR_BORROWED;
     }
     break;
   case V_ARRAY:
-    if (v_asize(src)) {
+    if (!v_asize(src)) {
+      v_init_array(dest);
+      dest->pack_type = src->pack_type;
+    } else if (v_share_lock) {
       v_copy_array(dest, src);
     } else {
-      v_init_array(dest);
+      v_share_array(dest, src);
     }
     break;
   case V_PTR:
@@ -549,13 +849,12 @@ void v_move(var_t *dest, const var_t *src) {
     dest->v.n = src->v.n;
     break;
   case V_STR:
-    dest->v.p.ptr = src->v.p.ptr;
-    dest->v.p.length = src->v.p.length;
-    dest->v.p.owner = src->v.p.owner;
+    dest->v.p = src->v.p;
     break;
   case V_ARRAY:
     memcpy(&dest->v.a, &src->v.a, sizeof(src->v.a));
     v_maxdim(dest) = v_maxdim(src);
+    dest->pack_type = src->pack_type;
     break;
   case V_PTR:
     dest->v.ap.p = src->v.ap.p;
@@ -628,7 +927,7 @@ int v_sign(var_t *x) {
  */
 void v_createstr(var_t *v, const char *src) {
   v_init_str(v, strlen(src));
-  strcpy(v->v.p.ptr, src);
+  strcpy(v_strptr(v), src);
 }
 
 /*
@@ -646,7 +945,7 @@ char *v_str(var_t *arg) {
     ftostr(arg->v.n, buffer);
     break;
   case V_STR:
-    buffer = strdup(arg->v.p.ptr);
+    buffer = strdup(v_strptr(arg));
     break;
   case V_ARRAY:
   case V_MAP:
@@ -677,7 +976,7 @@ void v_tostr(var_t *arg) {
     char *tmp = v_str(arg);
     v_free(arg);
     v_init_str(arg, strlen(tmp));
-    strcpy(arg->v.p.ptr, tmp);
+    strcpy(v_strptr(arg), tmp);
     free(tmp);
   }
 }
@@ -686,46 +985,74 @@ void v_tostr(var_t *arg) {
  * set the value of 'var' to string
  */
 void v_setstr(var_t *var, const char *str) {
-  if (var->type != V_STR || strcmp(str, var->v.p.ptr) != 0) {
+  if (var->type != V_STR || strcmp(str, v_strptr(var)) != 0) {
     v_free(var);
     v_init_str(var, strlen(str));
-    strcpy(var->v.p.ptr, str);
+    strcpy(v_strptr(var), str);
   }
 }
 
 void v_setstrn(var_t *var, const char *str, int len) {
-  if (var->type != V_STR || strncmp(str, var->v.p.ptr, len) != 0) {
+  if (var->type != V_STR || strncmp(str, v_strptr(var), len) != 0) {
     v_free(var);
     v_init_str(var, len);
-    strlcpy(var->v.p.ptr, str, len + 1);
+    strlcpy(v_strptr(var), str, len + 1);
   }
 }
 
 /*
- * adds a string to current string value
+ * returns the buffer size for an appended string. sizes are rounded up to a
+ * power of two so that realloc() only needs to move the buffer log(n) times
  */
-void v_strcat(var_t *var, const char *str) {
+static uint32_t v_str_capacity(uint32_t size) {
+  uint32_t capacity = STR_INIT_SIZE;
+  while (capacity < size && capacity < 0x80000000) {
+    capacity <<= 1;
+  }
+  return capacity < size ? size : capacity;
+}
+
+/*
+ * adds len bytes of str to current string value
+ */
+void v_strncat(var_t *var, const char *str, int len) {
   if (var->type == V_INT || var->type == V_NUM) {
     v_tostr(var);
   }
   if (var->type == V_STR) {
-    if (var->v.p.owner) {
-      var->v.p.length = strlen(var->v.p.ptr) + strlen(str) + 1;
-      var->v.p.ptr = realloc(var->v.p.ptr, var->v.p.length);
-      strcat(var->v.p.ptr, str);
-    } else {
+    int length = v_strlen(var);
+    uint32_t size = v_str_capacity(length + len + 1);
+    char *text = v_strptr(var);
+    // appending part of itself when str is held in the buffer
+    int self = (len && var->v.p.owner != V_STR_BORROWED &&
+                str >= text && str < text + length) ? str - text : -1;
+    if (var->v.p.owner == V_STR_OWNER) {
+      var->v.p.ptr = realloc(var->v.p.ptr, size);
+    } else if (var->v.p.owner != V_STR_INLINE || length + len >= V_STR_INLINE_SIZE) {
       // mutate into owner string
-      char *p = var->v.p.ptr;
-      int len = var->v.p.length + strlen(str);
-      v_init_str(var, len);
-      strcpy(var->v.p.ptr, p);
-      strcat(var->v.p.ptr, str);
+      char *p = malloc(size);
+      memcpy(p, text, length);
+      var->v.p.ptr = p;
+      var->v.p.owner = V_STR_OWNER;
     }
+    if (self != -1) {
+      str = v_strptr(var) + self;
+    }
+    memcpy(v_strptr(var) + length, str, len);
+    v_strptr(var)[length + len] = '\0';
+    var->v.p.length = length + len + 1;
   } else {
     err_typemismatch();
   }
 }
 
+/*
+ * adds a string to current string value
+ */
+void v_strcat(var_t *var, const char *str) {
+  v_strncat(var, str, strlen(str));
+}
+
 /*
  * set the value of 'var' to n
  */
@@ -751,7 +1078,7 @@ char *v_getstr(var_t *var) {
   if (var->type != V_STR) {
     v_tostr(var);
   }
-  return var->v.p.ptr;
+  return v_strptr(var);
 }
 
 /*
@@ -760,7 +1087,7 @@ char *v_getstr(var_t *var) {
 void v_zerostr(var_t *r) {
   v_free(r);
   v_init_str(r, 0);
-  r->v.p.ptr[0] = '\0';
+  v_strptr(r)[0] = '\0';
 }
 
 /*
@@ -93,6 +93,15 @@ typedef struct lab_s {
   bcip_t ip;
 } lab_t;
 
+/*
+ * remembers the map field resolved by a kwTYPE_UDS_EL call site
+ */
+typedef struct field_cache_s {
+  bcip_t ip;
+  uintptr_t stamp;
+  struct var_s *value;
+} field_cache_t;
+
 /**
  * @ingroup exec
  * @struct stknode_s
@@ -114,6 +123,13 @@ typedef struct stknode_s {
       bcip_t exit_ip; /**< EXIT command IP to go */
       code_t subtype; /**< kwTO | kwIN */
       byte flags; /**< ... */
+      code_t to_code; /**< counted loop: TO is kwTYPE_INT, kwTYPE_NUM or kwTYPE_VAR, 0 = not counted */
+      code_t step_code; /**< counted loop: STEP is kwTYPE_INT, kwTYPE_NUM or kwTYPE_VAR */
+      union {
+        var_int_t i;
+        var_num_t n;
+        bid_t id;
+      } to, step; /**< counted loop: TO/STEP constant or variable index */
     } vfor;
 
     /**
@@ -152,6 +168,7 @@ typedef struct stknode_s {
       var_t *retvar;   /**< return-variable data */
       bcip_t ret_ip;   /**< return ip */
       bid_t rvid;      /**< return-variable ID */
+      uint32_t frame; /**< index of the first frame variable of the call */
       int task_id; /**< task_id or -1 (this task) */
       uint16_t pcount; /**< number of parameters */
     } vcall;
@@ -188,13 +205,45 @@ typedef struct stknode_s {
   code_t type; /**< type of node (keyword id, i.e. kwGOSUB, kwFOR, etc) */
 } stknode_t;
 
+/**
+ * @ingroup exec
+ * @struct frame_var_s
+ *
+ * a parameter or local variable of a SUB/FUNC call. frame variables are
+ * allocated in blocks that never move, a call releases its own in one step
+ */
+typedef struct frame_var_s {
+  var_t var; /**< the value (unused for BYREF parameters), must be first */
+  var_t *vptr; /**< the variable that was replaced in tvar */
+  bid_t vid; /**< variable index in tvar, -1 when not yet bound */
+  uint8_t share_lock; /**< non-zero when holding v_share_lock for a BYREF element */
+} frame_var_t;
+
+/**
+ * @ingroup var
+ *
+ * var pool usage, see v_pool_stats()
+ */
+typedef struct var_pool_stats_s {
+  uint32_t count; /**< variables in use */
+  uint32_t high_water; /**< the most variables in use at one time */
+  uint32_t slabs; /**< slabs allocated */
+} var_pool_stats_t;
+
 /**
  * @ingroup var
  *
- * intialises the var pool
+ * releases the var pool, which grows again with the next v_new()
  */
 void v_init_pool(void);
 
+/**
+ * @ingroup var
+ *
+ * returns the var pool usage
+ */
+void v_pool_stats(var_pool_stats_t *stats);
+
 /**
  * @ingroup var
  *
@@ -285,6 +334,15 @@ void code_pop(stknode_t *node, int expected_type);
  */
 int code_pop_and_free();
 
+/**
+ * @ingroup exec
+ *
+ * releases the resources held by a stack node
+ *
+ * @param node the stack node
+ */
+void free_node(stknode_t *node);
+
 /**
  * @ingroup exec
  *
@@ -293,6 +351,53 @@ int code_pop_and_free();
  */
 stknode_t *code_stackpeek();
 
+/**
+ * @ingroup exec
+ *
+ * adds a new empty variable to the top of the frame stack
+ *
+ * @return the frame variable
+ */
+frame_var_t *frame_push();
+
+/**
+ * @ingroup exec
+ *
+ * replaces tvar[vid] with var until the frame variable is released
+ *
+ * @param fv the frame variable
+ * @param vid the variable index
+ * @param var the new variable, either &fv->var or the BYREF variable
+ */
+void frame_bind(frame_var_t *fv, bid_t vid, var_t *var);
+
+/**
+ * @ingroup exec
+ *
+ * releases the frame variables from base upwards, restoring tvar
+ *
+ * @param base the index of the first frame variable to release
+ */
+void frame_release(uint32_t base);
+
+/**
+ * @ingroup exec
+ *
+ * returns the frame variable at the given index
+ */
+frame_var_t *frame_at(uint32_t index);
+
+/**
+ * @ingroup exec
+ *
+ * releases the frame variables in [base, top) and moves the variables
+ * above top down to base. the moved variables must not be bound to tvar
+ *
+ * @param base the index of the first frame variable to release
+ * @param top the index of the first frame variable to keep
+ */
+void frame_drop(uint32_t base, uint32_t top);
+
 /**
  * @ingroup var
  *
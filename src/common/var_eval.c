@@ -16,6 +16,8 @@
 #include "common/var_eval.h"
 #include "common/plugins.h"
 
+#define MAX_ARRAY_LEVELS 8
+
 //
 // returns a temporary var that can exist in the calling scope
 //
@@ -39,10 +41,11 @@ void v_eval_func(var_p_t self, var_p_t v_func, var_p_t result) {
     }
   } else {
     // module callback
+    slib_par_t params[MAX_PARAMS];
     slib_par_t *ptable;
     int pcount;
     if (code_peek() == kwTYPE_LEVEL_BEGIN) {
-      ptable = (slib_par_t *)malloc(sizeof(slib_par_t) * MAX_PARAMS);
+      ptable = params;
       pcount = plugin_build_ptable(ptable, MAX_PARAMS);
     } else {
       ptable = NULL;
@@ -51,7 +54,7 @@ void v_eval_func(var_p_t self, var_p_t v_func, var_p_t result) {
     if (!prog_error) {
       if (!v_func->v.fn.mcb(self, pcount, ptable, result)) {
         if (result->type == V_STR) {
-          err_throw(result->v.p.ptr);
+          err_throw(v_strptr(result));
         } else {
           err_throw("Undefined");
         }
@@ -59,7 +62,6 @@ void v_eval_func(var_p_t self, var_p_t v_func, var_p_t result) {
     }
     if (ptable) {
       plugin_free_ptable(ptable, pcount);
-      free(ptable);
     }
   }
 }
@@ -179,7 +181,92 @@ var_t *code_getvarptr_arridx(var_t *basevar_p) {
   return var_p;
 }
 
-var_t *code_get_map_element(var_t *map, var_t *field) {
+/**
+ * Used by eval() and cmd_let() to access an element of a packed array without
+ * first converting the array to var_t elements
+ */
+var_t *code_getvarptr_packed(var_t *array, uint32_t *idx) {
+  var_t *var_p = NULL;
+
+  // skip kwTYPE_LEVEL_BEGIN
+  code_skipnext();
+  bcip_t array_index = get_array_idx(array);
+  if (!prog_error) {
+    if ((int) array_index >= v_asize(array) || (int) array_index < 0) {
+      err_arridx(array_index, v_asize(array));
+    } else if (code_peek() != kwTYPE_LEVEL_END) {
+      err_arrmis_rp();
+    } else {
+      code_skipnext();
+      byte code = code_peek();
+      if (code == kwTYPE_LEVEL_BEGIN) {
+        // there is a second array inside
+        var_p = v_is_packed(array) ? NULL : v_elem(array, array_index);
+        if (var_p == NULL || var_p->type != V_ARRAY) {
+          err_varisnotarray();
+          var_p = NULL;
+        } else {
+          var_p = code_resolve_varptr(var_p, 0);
+        }
+      } else if (code == kwTYPE_UDS_EL || !v_is_packed(array)) {
+        // the element becomes a map or the index expression converted the array
+        var_p = code_resolve_varptr(v_elem(array, array_index), 0);
+      } else {
+        *idx = array_index;
+      }
+    }
+  }
+  return var_p;
+}
+
+/**
+ * Used by eval() to read an element of an array without unsharing or
+ * unpacking its storage. the value of a packed element is copied into tmp
+ */
+var_t *code_getvarptr_read(var_t *array, var_t *tmp) {
+  uint32_t path[MAX_ARRAY_LEVELS];
+  int depth = 0;
+  var_t *var_p = array;
+
+  while (!prog_error) {
+    // skip kwTYPE_LEVEL_BEGIN
+    code_skipnext();
+    bcip_t array_index = get_array_idx(var_p);
+    if (prog_error) {
+      break;
+    } else if ((int) array_index >= v_asize(var_p) || (int) array_index < 0) {
+      err_arridx(array_index, v_asize(var_p));
+      break;
+    } else if (code_peek() != kwTYPE_LEVEL_END) {
+      err_arrmis_rp();
+      break;
+    }
+    code_skipnext();
+    path[depth++] = array_index;
+
+    byte code = code_peek();
+    if (code == kwTYPE_UDS_EL || (code == kwTYPE_LEVEL_BEGIN && depth == MAX_ARRAY_LEVELS)) {
+      // continue from the element with the writable path
+      var_p = array;
+      for (int i = 0; i < depth; i++) {
+        var_p = v_elem(var_p, path[i]);
+      }
+      return code_resolve_varptr(var_p, 0);
+    }
+    var_t *elem = v_array_get(var_p, array_index, tmp);
+    if (code != kwTYPE_LEVEL_BEGIN) {
+      return elem;
+    } else if (elem->type != V_ARRAY) {
+      err_varisnotarray();
+      break;
+    }
+    // there is a second array inside
+    var_p = elem;
+  }
+  return NULL;
+}
+
+var_t *code_get_map_element(var_t *map, var_t *field, int is_plain) {
   var_t *result = NULL;
 
   if (code_peek() != kwTYPE_LEVEL_BEGIN) {
@@ -187,7 +274,9 @@ var_t *code_get_map_element(var_t *map, var_t *field) {
   } else if (field->type == V_PTR) {
     prog_ip = cmd_push_args(kwFUNC, field->v.ap.p, field->v.ap.v);
     var_t *self = v_set_self(map);
+    v_share_lock += !is_plain;
     bc_loop(2);
+    v_share_lock -= !is_plain;
     v_set_self(self);
 
     if (!prog_error) {
@@ -255,6 +344,7 @@ var_t *code_resolve_varptr(var_t *var_p, int until_parens) {
  */
 var_t *code_resolve_map(var_t *var_p, int until_parens) {
   int deref = 1;
+  var_t *base = var_p;
   var_t *v_parent = var_p;
   while (deref && var_p != NULL) {
     switch (code_peek()) {
@@ -262,7 +352,7 @@ var_t *code_resolve_map(var_t *var_p, int until_parens) {
       if (until_parens) {
         deref = 0;
       } else {
-        var_p = code_get_map_element(v_parent, var_p);
+        var_p = code_get_map_element(v_parent, var_p, v_parent == base);
       }
       break;
     case kwTYPE_UDS_EL:
@@ -297,6 +387,7 @@ var_t *resolve_var_ref(var_t *var_p, int *is_ptr) {
  */
 var_t *code_isvar_resolve_map(var_t *var_p, int *is_ptr) {
   int deref = 1;
+  var_t *base = var_p;
   var_t *v_parent = var_p;
   while (deref && var_p != NULL) {
     switch (code_peek()) {
@@ -305,7 +396,7 @@ var_t *code_isvar_resolve_map(var_t *var_p, int *is_ptr) {
         *is_ptr = 1;
         deref = 0;
       } else {
-        var_p = code_get_map_element(v_parent, var_p);
+        var_p = code_get_map_element(v_parent, var_p, v_parent == base);
       }
       break;
     case kwTYPE_UDS_EL:
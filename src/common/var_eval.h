@@ -42,6 +42,22 @@ var_t *code_resolve_map(var_t *var_p, int until_parens);
  */
 var_t *code_resolve_varptr(var_t *var_p, int until_parens);
 
+/**
+ * @ingroup var
+ *
+ * resolve the element of a packed array. returns NULL with the element index
+ * in idx, or the resolved variable when the reference needs a var_t element
+ */
+var_t *code_getvarptr_packed(var_t *array, uint32_t *idx);
+
+/**
+ * @ingroup var
+ *
+ * resolve an array element for reading. the storage remains shared and
+ * packed, the value of a packed element is returned in tmp
+ */
+var_t *code_getvarptr_read(var_t *array, var_t *tmp);
+
 /**
  * @ingroup var
  *
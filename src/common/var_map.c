@@ -15,7 +15,6 @@
 #include "include/var_map.h"
 
 #define BUFFER_GROW_SIZE 64
-#define BUFFER_PADDING   10
 #define TOKEN_GROW_SIZE  16
 #define JSMN_STATIC
 
@@ -89,7 +88,24 @@ int map_length(const var_p_t var_p) {
   return result;
 }
 
+//
+// return the value for update, a shared table is first copied
+//
 var_p_t map_get(var_p_t base, const char *name) {
+  var_p_t result;
+  if (base != NULL && base->type == V_MAP) {
+    hashmap_unshare(base);
+    result = hashmap_get(base, name);
+  } else {
+    result = NULL;
+  }
+  return result;
+}
+
+//
+// return the value for reading, a shared table is not copied
+//
+static var_p_t map_read(var_p_t base, const char *name) {
   var_p_t result;
   if (base != NULL && base->type == V_MAP) {
     result = hashmap_get(base, name);
@@ -101,7 +117,7 @@ var_p_t map_get(var_p_t base, const char *name) {
 
 int map_get_bool(var_p_t base, const char *name) {
   int result = 0;
-  var_p_t var = map_get(base, name);
+  var_p_t var = map_read(base, name);
   if (var != NULL) {
     switch (var->type) {
     case V_INT:
@@ -111,7 +127,7 @@ int map_get_bool(var_p_t base, const char *name) {
       result = (var->v.n != 0);
       break;
     case V_STR:
-      result = (strncasecmp(var->v.p.ptr, "true", 4));
+      result = (strncasecmp(v_strptr(var), "true", 4));
       break;
     }
   }
@@ -119,47 +135,28 @@ int map_get_bool(var_p_t base, const char *name) {
 }
 
 int map_get_int(var_p_t base, const char *name, int def) {
-  var_p_t var = map_get(base, name);
+  var_p_t var = map_read(base, name);
   return var != NULL ? v_igetval(var) : def;
 }
 
 const char *map_get_str(var_p_t base, const char *name) {
   char *result;
-  var_p_t var = map_get(base, name);
+  var_p_t var = map_read(base, name);
   if (var != NULL && var->type == V_STR) {
-    result = var->v.p.ptr;
+    result = v_strptr(var);
   } else {
     result = NULL;
   }
   return result;
 }
 
-//
-// return the element at the nth position
-//
-int map_elem_cb(hashmap_cb *cb, var_p_t key, var_p_t value) {
-  int result;
-  if (cb->count++ == cb->index) {
-    cb->var = key;
-    result = 1;
-  } else {
-    result = 0;
-  }
-  return result;
-}
-
 //
 // return the element key at the nth position
 //
 var_p_t map_elem_key(const var_p_t var_p, int index) {
   var_p_t result;
   if (var_p->type == V_MAP) {
-    hashmap_cb cb;
-    cb.count = 0;
-    cb.index = index;
-    cb.var = NULL;
-    hashmap_foreach(var_p, map_elem_cb, &cb);
-    result = cb.var;
+    result = hashmap_key_at(var_p, index);
   } else {
     result = NULL;
   }
@@ -199,6 +196,7 @@ void map_set_lib_id(var_p_t var_p, int lib_id) {
     hashmap_cb cb;
     var_p->v.m.lib_id = lib_id;
     cb.index = lib_id;
+    hashmap_unshare(var_p);
     hashmap_foreach(var_p, map_set_lib_id_cb, &cb);
   }
 }
@@ -211,6 +209,7 @@ void map_set_lib_id(var_p_t var_p, int lib_id) {
 var_p_t map_resolve_fields(var_p_t base, var_p_t *parent) {
   var_p_t field = NULL;
   if (code_peek() == kwTYPE_UDS_EL) {
+    bcip_t site = prog_ip;
     code_skipnext();
     if (code_peek() != kwTYPE_STR) {
       err_stackmess();
@@ -235,7 +234,18 @@ var_p_t map_resolve_fields(var_p_t base, var_p_t *parent) {
     int len = code_getstrlen();
     const char *key = (const char *)&prog_source[prog_ip];
     prog_ip += len;
-    field = hashmap_putc(base, key, len);
+
+    // reuse the field found by the last visit when the table is unchanged
+    field_cache_t *cache = &prog_fieldcache[site & prog_fieldmask];
+    uintptr_t stamp = hashmap_stamp(base);
+    if (stamp != 0 && cache->stamp == stamp && cache->ip == site) {
+      field = cache->value;
+    } else {
+      field = hashmap_putc(base, key, len);
+      cache->ip = site;
+      cache->stamp = hashmap_stamp(base);
+      cache->value = field;
+    }
     if (parent != NULL) {
       *parent = base;
     }
@@ -248,6 +258,43 @@ var_p_t map_resolve_fields(var_p_t base, var_p_t *parent) {
   return field;
 }
 
+//
+// Returns the final element eg z in foo.x.y.z for reading. shared tables are
+// not copied, returns NULL when a field is missing or is not a map
+//
+var_p_t map_read_fields(var_p_t base) {
+  var_p_t field = base;
+  while (field != NULL && code_peek() == kwTYPE_UDS_EL) {
+    bcip_t site = prog_ip;
+    if (field->type == V_REF) {
+      field = field->v.ref;
+    }
+    if (field->type != V_MAP || prog_source[site + 1] != kwTYPE_STR) {
+      return NULL;
+    }
+    prog_ip += 2;
+
+    int len = code_getstrlen();
+    const char *key = (const char *)&prog_source[prog_ip];
+    prog_ip += len;
+
+    // reuse the field found by the last visit to the same table
+    field_cache_t *cache = &prog_fieldcache[site & prog_fieldmask];
+    uintptr_t stamp = hashmap_read_stamp(field);
+    if (stamp != 0 && cache->stamp == stamp && cache->ip == site) {
+      field = cache->value;
+    } else {
+      field = hashmap_getc(field, key, len);
+      if (field != NULL && stamp != 0) {
+        cache->ip = site;
+        cache->stamp = stamp;
+        cache->value = field;
+      }
+    }
+  }
+  return field;
+}
+
 //
 // Adds a new variable onto the map
 //
@@ -291,14 +338,14 @@ void map_get_value(var_p_t base, var_p_t var_key, var_p_t *result) {
   }
 
   v_tostr(var_key);
-  *result = hashmap_put(base, var_key->v.p.ptr, v_strlen(var_key));
+  *result = hashmap_put(base, v_strptr(var_key), v_strlen(var_key));
 }
 
 //
 // Traverse the root to copy into dest
 //
 int map_set_cb(hashmap_cb *cb, var_p_t var_key, var_p_t value) {
-  if (var_key->type != V_STR || var_key->v.p.ptr[0] != MAP_TMP_FIELD[0]) {
+  if (var_key->type != V_STR || v_strptr(var_key)[0] != MAP_TMP_FIELD[0]) {
     var_p_t key = v_new();
     v_set(key, var_key);
     var_p_t var = hashmap_putv(cb->var, key);
@@ -308,10 +355,11 @@ int map_set_cb(hashmap_cb *cb, var_p_t var_key, var_p_t value) {
 }
 
 //
-// Copy values from one structure to another
+// Copy values from one structure to another. the structure is shared until
+// either variable is modified
 //
 void map_set(var_p_t dest, const var_p_t src) {
-  if (dest != src && src->type == V_MAP) {
+  if (dest != src && src->type == V_MAP && v_share_lock) {
     hashmap_cb cb;
     cb.var = dest;
     hashmap_create(dest, src->v.m.count);
@@ -320,6 +368,8 @@ void map_set(var_p_t dest, const var_p_t src) {
     dest->v.m.id = src->v.m.id;
     dest->v.m.lib_id = -1;
     dest->v.m.cls_id = -1;
+  } else if (dest != src && src->type == V_MAP) {
+    hashmap_share(dest, src);
   }
 }
 
@@ -332,31 +382,46 @@ void map_set_int(var_p_t base, const char *name, var_int_t n) {
   }
 }
 
+//
+// Append len bytes to the map_to_str buffer, doubling its size as needed.
+// cb->count is the buffer size, cb->index the length of the text
+//
+static void map_buffer_append(hashmap_cb *cb, const char *str, int len) {
+  int required = cb->index + len + 1;
+  if (required > cb->count) {
+    while (cb->count < required) {
+      cb->count *= 2;
+    }
+    cb->buffer = realloc(cb->buffer, cb->count);
+  }
+  memcpy(cb->buffer + cb->index, str, len);
+  cb->index += len;
+  cb->buffer[cb->index] = '\0';
+}
+
+static void map_buffer_cat(hashmap_cb *cb, const char *str) {
+  map_buffer_append(cb, str, strlen(str));
+}
+
 //
 // Helper for map_to_str
 //
 int map_to_str_cb(hashmap_cb *cb, var_p_t v_key, var_p_t v_var) {
   char *key = v_str(v_key);
   char *value = v_str(v_var);
-  int required = strlen(cb->buffer) + strlen(key) + strlen(value) + BUFFER_PADDING;
-  if (required >= cb->count) {
-    cb->count = required + BUFFER_GROW_SIZE;
-    cb->buffer = realloc(cb->buffer, cb->count);
-  }
   if (!cb->start) {
-    strcat(cb->buffer, ",");
+    map_buffer_cat(cb, ",");
   }
   cb->start = 0;
-  strcat(cb->buffer, "\"");
-  strcat(cb->buffer, key);
-  strcat(cb->buffer, "\"");
-  strcat(cb->buffer, ":");
+  map_buffer_cat(cb, "\"");
+  map_buffer_cat(cb, key);
+  map_buffer_cat(cb, "\":");
   if (v_var->type == V_STR) {
-    strcat(cb->buffer, "\"");
+    map_buffer_cat(cb, "\"");
   }
-  strcat(cb->buffer, value);
+  map_buffer_cat(cb, value);
   if (v_var->type == V_STR) {
-    strcat(cb->buffer, "\"");
+    map_buffer_cat(cb, "\"");
   }
   free(key);
   free(value);
@@ -367,21 +432,20 @@ int map_to_str_cb(hashmap_cb *cb, var_p_t v_key, var_p_t v_var) {
 // Print the array element, growing the buffer as needed
 //
 void array_append_elem(hashmap_cb *cb, var_t *elem) {
-  char *value = v_str(elem);
-  int required = strlen(cb->buffer) + strlen(value) + BUFFER_PADDING;
-  if (required >= cb->count) {
-    cb->count = required + BUFFER_GROW_SIZE;
-    cb->buffer = realloc(cb->buffer, cb->count);
+  if (elem->type == V_STR) {
+    map_buffer_cat(cb, v_strptr(elem));
+  } else {
+    char *value = v_str(elem);
+    map_buffer_cat(cb, value);
+    free(value);
   }
-  strcat(cb->buffer, value);
-  free(value);
 }
 
 //
 // print the array variable
 //
 void array_to_str(hashmap_cb *cb, var_t *var) {
-  strcpy(cb->buffer, "[");
+  map_buffer_cat(cb, "[");
   if (v_maxdim(var) == 2) {
     // NxN
     int rows = ABS(v_ubound(var, 0) - v_lbound(var, 0)) + 1;
@@ -390,26 +454,28 @@ void array_to_str(hashmap_cb *cb, var_t *var) {
     for (int i = 0; i < rows; i++) {
       for (int j = 0; j < cols; j++) {
         int pos = i * cols + j;
-        var_t *elem = v_elem(var, pos);
+        var_t tmp;
+        var_t *elem = v_array_get(var, pos, &tmp);
         array_append_elem(cb, elem);
         if (j != cols - 1) {
-          strcat(cb->buffer, ",");
+          map_buffer_cat(cb, ",");
         }
       }
       if (i != rows - 1) {
-        strcat(cb->buffer, ";");
+        map_buffer_cat(cb, ";");
       }
     }
   } else {
     for (int i = 0; i < v_asize(var); i++) {
-      var_t *elem = v_elem(var, i);
+      var_t tmp;
+      var_t *elem = v_array_get(var, i, &tmp);
       array_append_elem(cb, elem);
       if (i != v_asize(var) - 1) {
-        strcat(cb->buffer, ",");
+        map_buffer_cat(cb, ",");
       }
     }
   }
-  strcat(cb->buffer, "]");
+  map_buffer_cat(cb, "]");
 }
 
 //
@@ -418,13 +484,15 @@ void array_to_str(hashmap_cb *cb, var_t *var) {
 char *map_to_str(const var_p_t var_p) {
   hashmap_cb cb;
   cb.count = BUFFER_GROW_SIZE;
+  cb.index = 0;
   cb.buffer = malloc(cb.count);
+  cb.buffer[0] = '\0';
 
   if (var_p->type == V_MAP) {
     cb.start = 1;
-    strcpy(cb.buffer, "{");
+    map_buffer_cat(&cb, "{");
     hashmap_foreach(var_p, map_to_str_cb, &cb);
-    strcat(cb.buffer, "}");
+    map_buffer_cat(&cb, "}");
   } else if (var_p->type == V_ARRAY) {
     array_to_str(&cb, var_p);
   }
@@ -666,7 +734,7 @@ void map_from_str(var_p_t dest) {
     if (arg.type != V_STR) {
       v_set(dest, &arg);
     } else {
-      map_parse_str(arg.v.p.ptr, arg.v.p.length, dest);
+      map_parse_str(v_strptr(&arg), arg.v.p.length, dest);
     }
   }
   v_free(&arg);
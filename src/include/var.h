@@ -42,6 +42,23 @@ typedef long long int var_int_t;
 #define V_FUNC      7 /**< variable type, object method                @ingroup var */
 #define V_NIL       8 /**< variable type, null value                   @ingroup var */
 
+/*
+ * String - storage, the v.p.owner values
+ */
+#define V_STR_BORROWED 0 /**< string text is held elsewhere             @ingroup var */
+#define V_STR_OWNER    1 /**< string text is allocated for the variable @ingroup var */
+#define V_STR_INLINE   2 /**< string text is held within the variable   @ingroup var */
+
+// bytes available for the text and NUL of an inline string
+#define V_STR_INLINE_SIZE 16
+
+/*
+ * Array - element types
+ */
+#define V_PACK_NONE 0 /**< array element type, var_t                   @ingroup var */
+#define V_PACK_INT  1 /**< array element type, packed var_int_t        @ingroup var */
+#define V_PACK_NUM  2 /**< array element type, packed var_num_t        @ingroup var */
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -62,6 +79,12 @@ typedef int (*callback) (struct var_s *self, int param_count, slib_par_t *params
 // signature for internal v_funcs
 typedef void (*method) (struct var_s *self, struct var_s *retval);
 
+// upper and lower bounds of an array with more than one dimension
+typedef struct var_dim_s {
+  int32_t ubound[MAXDIM];
+  int32_t lbound[MAXDIM];
+} var_dim_t;
+
 typedef struct var_s {
   union {
     // numeric
@@ -86,8 +109,8 @@ typedef struct var_s {
       uint32_t count;
       uint32_t size;
       uint32_t id;
-      uint32_t lib_id;
-      uint32_t cls_id;
+      int16_t lib_id;
+      int16_t cls_id;
     } m;
 
     // reference variable
@@ -102,8 +125,13 @@ typedef struct var_s {
 
     // generic ptr (string)
     struct {
-      char *ptr;
+      union {
+        char *ptr;
+        // the text of a short string, see v_strptr()
+        char buf[V_STR_INLINE_SIZE];
+      };
       uint32_t length;
+      // V_STR_BORROWED, V_STR_OWNER or V_STR_INLINE
       uint8_t owner;
     } p;
 
@@ -114,9 +142,12 @@ typedef struct var_s {
       uint32_t size;
       // the number of available element slots
       uint32_t capacity;
-      // upper and lower bounds
-      int32_t ubound[MAXDIM];
-      int32_t lbound[MAXDIM];
+      union {
+        // lower and upper bound of a single dimension array
+        int32_t bound[2];
+        // bounds of a multi-dimensional array, see v_set_maxdim()
+        struct var_dim_s *dims;
+      } dim;
     } a;
 
     // next item in the free-list
@@ -134,10 +165,27 @@ typedef struct var_s {
 
   // whether help in pooled memory
   uint8_t pooled;
+
+  // array element type, V_PACK_NONE or the type of the packed elements
+  uint8_t pack_type;
 } var_t;
 
 typedef var_t *var_p_t;
 
+/**
+ * @ingroup var
+ *
+ * header ahead of array and map storage, which is shared by v_set() until
+ * one of the variables is modified
+ */
+typedef struct var_shared_s {
+  // the number of variables holding the storage
+  uint32_t refs;
+
+  // the number of map table slots
+  uint32_t size;
+} var_shared_t;
+
 /**
  * @ingroup var
  *
@@ -156,6 +204,13 @@ var_t *v_new(void);
  */
 void v_new_array(var_t *var, unsigned size);
 
+/**
+ * @ingroup var
+ *
+ * creates a new packed array of V_PACK_INT or V_PACK_NUM elements
+ */
+void v_new_packed_array(var_t *var, unsigned size, uint8_t pack_type);
+
 /**
  * @ingroup var
  *
@@ -163,6 +218,76 @@ void v_new_array(var_t *var, unsigned size);
  */
 void v_array_free(var_t *var);
 
+/**
+ * @ingroup var
+ *
+ * sets the number of array dimensions. the bounds of the first dimension
+ * are retained, the bounds of any other dimension must then be assigned
+ */
+void v_set_maxdim(var_t *var, int maxdim);
+
+/**
+ * @ingroup var
+ *
+ * converts the array elements to the given V_PACK_xxx type
+ */
+void v_array_pack(var_t *var, uint8_t pack_type);
+
+/**
+ * @ingroup var
+ *
+ * converts a packed array to var_t elements
+ *
+ * @return the var_t elements
+ */
+struct var_s *v_array_unpack(var_t *var);
+
+/**
+ * @ingroup var
+ *
+ * moves the value into element i of the array. packed arrays store numbers
+ * as the element type, any other value converts the array to var_t elements
+ */
+void v_array_set(var_t *var, uint32_t i, var_t *value);
+
+/**
+ * @ingroup var
+ *
+ * takes a private copy of array storage shared with other variables
+ */
+void v_array_unshare(var_t *var);
+
+/**
+ * @ingroup var
+ *
+ * returns the var_t elements for writing. packed or shared storage is first
+ * converted to a private copy
+ *
+ * @return the var_t elements
+ */
+struct var_s *v_array_elems(var_t *var);
+
+/**
+ * @ingroup var
+ *
+ * allocates zeroed array or map storage with a reference count of one
+ */
+void *v_shared_new(size_t size);
+
+/**
+ * @ingroup var
+ *
+ * resizes storage that is not shared
+ */
+void *v_shared_resize(void *data, size_t size);
+
+/**
+ * @ingroup var
+ *
+ * frees storage allocated by v_shared_new()
+ */
+void v_shared_free(void *data);
+
 /**
  * @ingroup var
  *
@@ -177,6 +302,14 @@ void v_init_str(var_t *var, int length);
  */
 void v_move_str(var_t *var, char *str);
 
+/**
+ * @ingroup var
+ *
+ * moves the text of a short inline string into allocated memory, for code
+ * which reads v.p.ptr directly
+ */
+void v_strheap(var_t *var);
+
 /**
  * @ingroup var
  *
@@ -220,6 +353,16 @@ int v_addtype(var_t *a, var_t *b);
  */
 void v_add(var_t *result, var_t *a, var_t *b);
 
+/**
+ * @ingroup var
+ *
+ * adds b to the variable, a = a + b. a string is appended in place
+ *
+ * @param a the left-side variable
+ * @param b the right-side variable
+ */
+void v_append(var_t *a, var_t *b);
+
 /**
  * @ingroup var
  *
@@ -381,6 +524,18 @@ void v_setstrn(var_t *var, const char *string, int len);
  */
 void v_strcat(var_t *var, const char *string);
 
+/**
+ * @ingroup var
+ *
+ * concate len bytes of string to variable 'var'. the variable's buffer
+ * grows geometrically so that repeated appends take amortized O(len)
+ *
+ * @param var is the variable
+ * @param string is the string
+ * @param len the number of bytes to append
+ */
+void v_strncat(var_t *var, const char *string, int len);
+
 /**
  * @ingroup var
  *
@@ -423,12 +578,43 @@ void v_zerostr(var_t *var);
  */
 void v_input2var(const char *str, var_t *var);
 
+/**
+ * < non-zero when the array elements are packed numbers (x)
+ * @ingroup var
+ */
+#define v_is_packed(x) ((x)->pack_type != V_PACK_NONE)
+
+/**
+ * < the elements of a V_PACK_INT array (x)
+ * @ingroup var
+ */
+#define v_idata(x) ((var_int_t *)(x)->v.a.data)
+
+/**
+ * < the elements of a V_PACK_NUM array (x)
+ * @ingroup var
+ */
+#define v_ndata(x) ((var_num_t *)(x)->v.a.data)
+
+/**
+ * < the var_shared_t header of array or map storage (data)
+ * @ingroup var
+ */
+#define v_shared_hdr(data) (((var_shared_t *)(data)) - 1)
+
+/**
+ * < non-zero when the array storage is held by more than one variable (x)
+ * @ingroup var
+ */
+#define v_is_shared(x) ((x)->v.a.data != NULL && v_shared_hdr((x)->v.a.data)->refs > 1)
+
 /**
  *< returns the var_t pointer of the element i
  * on the array x. i is a zero-based, one dim, index.
+ * packed or shared storage is first converted to a private copy
  * @ingroup var
 */
-#define v_elem(var, i) &((var)->v.a.data[i])
+#define v_elem(var, i) &((v_is_packed(var) || v_is_shared(var) ? v_array_elems(var) : (var)->v.a.data)[i])
 
 /**
  * < the number of the elements of the array (x)
@@ -446,13 +632,22 @@ void v_input2var(const char *str, var_t *var);
  * < the array lower bound of the given dimension (x)
  * @ingroup var
  */
-#define v_lbound(x, i) ((x)->v.a.lbound[i])
+#define v_lbound(x, i) (*((x)->maxdim > 1 ? &(x)->v.a.dim.dims->lbound[i] : &(x)->v.a.dim.bound[0]))
 
 /**
  * < the array upper bound of the given dimension (x)
  * @ingroup var
  */
-#define v_ubound(x, i) ((x)->v.a.ubound[i])
+#define v_ubound(x, i) (*((x)->maxdim > 1 ? &(x)->v.a.dim.dims->ubound[i] : &(x)->v.a.dim.bound[1]))
+
+/**
+ * < the text of a string variable (x). always use this rather than v.p.ptr
+ * since short strings are held inline. a plugin's string parameters have
+ * allocated text, the strings held by their array elements and map entries
+ * may not
+ * @ingroup var
+ */
+#define v_strptr(x) ((x)->v.p.owner == V_STR_INLINE ? (char *)(x)->v.p.buf : (x)->v.p.ptr)
 
 /**
  * < the array data
@@ -478,6 +478,8 @@ struct proc_keyword_s proc_table[] = {
 #define LCN_AUTOLOCAL           "AUTOLOCAL"
 #define LCN_AS_WRS              "AS "
 #define LCN_CONST               "CONST"
+#define LCN_INTEGER             "INTEGER"
+#define LCN_REAL                "REAL"
 
 /* system variables */
 #define LCN_SV_SBVER            "SBVER"
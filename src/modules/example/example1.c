@@ -24,7 +24,7 @@ void print_var_t(int level, var_t *param) {
   // print var_t
   switch ( param->type )  {
   case  V_STR:
-    printf("STR  =\"%s\"\n", param->v.p.ptr);
+    printf("STR  =\"%s\"\n", v_strptr(param));
     break;
   case  V_INT:
     printf("INT  = %ld\n",    param->v.i);
@@ -53,7 +53,7 @@ int mod_parstr_ptr(int n, slib_par_t *params, int param_count, char **ptr) {
   if (param->type != V_STR) {
     v_tostr(param);
   }
-  *ptr = param->v.p.ptr;
+  *ptr = v_strptr(param);
 
   return 1;
 }
@@ -69,7 +69,7 @@ int mod_opt_parstr_ptr(int n, slib_par_t *params, int param_count, char **ptr, c
     if (param->type != V_STR) {
       v_tostr(param);
     }
-    *ptr = param->v.p.ptr;
+    *ptr = v_strptr(param);
   }
   else {
     *ptr = (char *)def_val;
@@ -239,6 +239,24 @@ void dump_bytecode(FILE *output) {
       fprintf(output, "call user-defined function %d", code_getaddr());
       fprintf(output, ", return-variable: %d", code_getaddr());
       break;
+    case kwLET_ADD_INT:
+      fprintf(output, "LET v = v +/- int");
+      break;
+    case kwLET_ELEM_INT:
+      fprintf(output, "LET v = a(int)");
+      break;
+    case kwLET_APPEND:
+      fprintf(output, "LET s = s + expr");
+      break;
+    case kwPRINT_VAR:
+      fprintf(output, "PRINT v");
+      break;
+    case kwTYPE_VAR_OPR_INT:
+      fprintf(output, "v +/-/cmp int; id %d", code_getaddr());
+      break;
+    case kwTAIL_CALL:
+      fprintf(output, "LET rv = f(...) tail call");
+      break;
     case kwEXIT:
       fprintf(output, "exit ");
       c = code_getnext();
@@ -191,7 +191,7 @@ ImageBuffer *load_image(dev_file_t *filep) {
       } else {
         var_p = v_new();
         http_read(filep, var_p);
-        error = lodepng_decode32(&image, &w, &h, (uint8_t *)var_p->v.p.ptr, var_p->v.p.length);
+        error = lodepng_decode32(&image, &w, &h, (uint8_t *)v_strptr(var_p), var_p->v.p.length);
         v_free(var_p);
         v_detach(var_p);
       }
@@ -411,7 +411,7 @@ void cmd_image_save(var_s *self, var_s *) {
       v_init(&var);
       eval(&var);
       if (var.type == V_STR && !prog_error) {
-        error = lodepng_encode32_file(var.v.p.ptr, image->_image, w, h);
+        error = lodepng_encode32_file(v_strptr(&var), image->_image, w, h);
       }
       v_free(&var);
       break;
@@ -472,7 +472,7 @@ extern "C" void v_create_image(var_p_t var) {
     eval(&arg);
     if (arg.type == V_STR && !prog_error) {
       dev_file_t file;
-      strlcpy(file.name, arg.v.p.ptr, sizeof(file.name));
+      strlcpy(file.name, v_strptr(&arg), sizeof(file.name));
       file.type = ft_stream;
       image = load_image(&file);
     } else if (arg.type == V_ARRAY && v_asize(&arg) > 0 && !prog_error) {
@@ -481,7 +481,7 @@ extern "C" void v_create_image(var_p_t var) {
         char **data = new char*[v_asize(&arg)];
         for (unsigned i = 0; i < v_asize(&arg); i++) {
           var_p_t elem = v_elem(&arg, i);
-          data[i] = elem->v.p.ptr;
+          data[i] = v_strptr(elem);
         }
         image = load_xpm_image(data);
         delete [] data;
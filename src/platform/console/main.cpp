@@ -28,11 +28,14 @@ static struct option OPTIONS[] = {
   {"keywords",       no_argument,       NULL, 'k'},
   {"no-file-access", no_argument,       NULL, 'f'},
   {"gen-sbx",        no_argument,       NULL, 'x'},
+  {"cache-dir",      optional_argument, NULL, 'd'},
   {"live-mode",      no_argument,       NULL, 'i'},
   {"module-path",    optional_argument, NULL, 'm'},
   {"decompile",      optional_argument, NULL, 's'},
   {"option",         optional_argument, NULL, 'o'},
   {"cmd",            optional_argument, NULL, 'c'},
+  {"event-budget",   optional_argument, NULL, 'e'},
+  {"stack-limit",    optional_argument, NULL, 'l'},
   {"stdin",          optional_argument, NULL, '-'},
   {"help",           optional_argument, NULL, 'h'},
   {0, 0, 0, 0}
@@ -181,6 +184,51 @@ bool setup_command_program(const char *program, char **runFile) {
   return result;
 }
 
+//
+// setup the bytecode cache directory, by default $XDG_CACHE_HOME/smallbasic
+//
+bool setup_cache_dir(const char *dir) {
+  char path[OPT_CACHE_SZ];
+  path[0] = '\0';
+  if (dir != nullptr && dir[0] != '\0') {
+    strlcpy(path, dir, sizeof(path));
+  } else if (getenv("XDG_CACHE_HOME") != nullptr && getenv("XDG_CACHE_HOME")[0] != '\0') {
+    strlcpy(path, getenv("XDG_CACHE_HOME"), sizeof(path));
+    strlcat(path, "/smallbasic", sizeof(path));
+  } else if (getenv("HOME") != nullptr) {
+    strlcpy(path, getenv("HOME"), sizeof(path));
+    strlcat(path, "/.cache/smallbasic", sizeof(path));
+  }
+
+  // create any missing parents
+  for (char *sep = strchr(path + 1, '/'); path[0] != '\0'; sep = strchr(sep + 1, '/')) {
+    if (sep != nullptr) {
+      *sep = '\0';
+    }
+    if (access(path, F_OK) != 0) {
+#if defined(_Win32)
+      mkdir(path);
+#else
+      mkdir(path, 0700);
+#endif
+    }
+    if (sep == nullptr) {
+      break;
+    }
+    *sep = '/';
+  }
+
+  bool result;
+  if (path[0] != '\0' && access(path, R_OK | W_OK) == 0) {
+    strlcpy(opt_cachedir, path, sizeof(opt_cachedir));
+    result = true;
+  } else {
+    fprintf(stdout, "sbasic: can't use cache path '%s': [Errno %d] %s\n", path, errno, strerror(errno));
+    result = false;
+  }
+  return result;
+}
+
 void print_taskinfo(FILE *output) {
   int prev_tid = 0;
 
@@ -242,7 +290,7 @@ bool process_options(int argc, char *argv[], char **runFile, bool *tmpFile, bool
   bool result = true;
   while (result) {
     int option_index = 0;
-    int c = getopt_long(argc, argv, "vkfxim:s:o:c:h::", OPTIONS, &option_index);
+    int c = getopt_long(argc, argv, "vkfxd::im:s:o:c:e:l:h::", OPTIONS, &option_index);
     if (c == -1 && !option_index) {
       // no more options
       for (int i = 1; i < argc; i++) {
@@ -286,6 +334,11 @@ bool process_options(int argc, char *argv[], char **runFile, bool *tmpFile, bool
     case 'x':
       opt_nosave = 0;
       break;
+    case 'd':
+      if (!setup_cache_dir(optarg)) {
+        result = false;
+      }
+      break;
     case 'm':
       if (optarg) {
         strcpy(opt_modpath, optarg);
@@ -313,6 +366,16 @@ bool process_options(int argc, char *argv[], char **runFile, bool *tmpFile, bool
     case 'i':
       *iterate = true;
       break;
+    case 'e':
+      if (optarg) {
+        opt_event_budget = atoi(optarg);
+      }
+      break;
+    case 'l':
+      if (optarg) {
+        opt_stack_limit = atoi(optarg);
+      }
+      break;
     default:
       show_help();
       result = false;
@@ -410,7 +473,10 @@ static void exit_handler(void) {
 int main(int argc, char *argv[]) {
   opt_autolocal = 0;
   opt_command[0] = '\0';
+  opt_event_budget = 0;
+  opt_stack_limit = 0;
   opt_modpath[0] = '\0';
+  opt_cachedir[0] = '\0';
   opt_file_permitted = 1;
   opt_ide = 0;
   opt_nosave = 1;
@@ -440,6 +506,7 @@ int main(int argc, char *argv[]) {
         }
       }
     } while (iterate);
+    unit_cache_invalidate(nullptr);
     chdir(prev_cwd);
     if (tmpFile) {
       unlink(file);
@@ -920,6 +920,7 @@ int main(int argc, char **argv) {
   int result;
   if (initialise(argc, argv)) {
     Fl::run();
+    unit_cache_invalidate(nullptr);
     result = 0;
   } else {
     result = 1;
@@ -816,6 +816,15 @@ void dumpVariables(socket_t socket) {
       break;
     case kwFUNC:
     case kwPROC:
+      // parameters and locals
+      for (uint32_t f = node.x.vcall.frame; f < prog_frame_count; f++) {
+        frame_var_t *fv = frame_at(f);
+        if (fv->vid != -1) {
+          net_printf(socket, "[%d] ", count++);
+          pv_writevar(tvar[fv->vid], PV_NET, socket);
+          net_print(socket, "\n");
+        }
+      }
       localScope = true;
       break;
     }
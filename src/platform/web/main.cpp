@@ -326,6 +326,7 @@ int main(int argc, char **argv) {
     getc(stdin);
     MHD_stop_daemon(d);
   }
+  unit_cache_invalidate(nullptr);
   free(execBas);
   return 0;
 }
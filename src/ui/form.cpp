@@ -30,7 +30,7 @@ const char *FormInput::getValue() {
   if (field != nullptr) {
     var_p_t value = map_get(field, FORM_INPUT_VALUE);
     if (value != nullptr && value->type == V_STR) {
-      result = value->v.p.ptr;
+      result = v_strptr(value);
     }
   }
   return result;
@@ -124,7 +124,7 @@ void cmd_form_close(var_s *self, var_s *) {
   v_init(&arg);
   eval(&arg);
   if (arg.type == V_STR) {
-    g_system->setLoadBreak(arg.v.p.ptr);
+    g_system->setLoadBreak(v_strptr(&arg));
   }
   v_free(&arg);
 }
@@ -239,7 +239,7 @@ FormInput *create_input(var_p_t v_field) {
     }
     const char *text = nullptr;
     if (value->type == V_STR) {
-      text = value->v.p.ptr;
+      text = v_strptr(value);
     }
     if (h * 2 >= charHeight) {
       widget = new TextEditInput(text, charWidth, charHeight, x, y, w, h);
@@ -322,7 +322,7 @@ ImageBuffer *load_image(dev_file_t *filep) {
       } else {
         var_p = v_new();
         http_read(filep, var_p);
-        error = decode_png(&image, &w, &h, (unsigned char *)var_p->v.p.ptr, var_p->v.p.length);
+        error = decode_png(&image, &w, &h, (unsigned char *)v_strptr(var_p), var_p->v.p.length);
         v_free(var_p);
         v_detach(var_p);
       }
@@ -478,7 +478,7 @@ void cmd_image_save(var_s *self, var_s *) {
     case kwTYPE_STR:
       par_getstr(&str);
       if (!prog_error &&
-          !encode_png_file(str.v.p.ptr, image->_image, w, h)) {
+          !encode_png_file(v_strptr(&str), image->_image, w, h)) {
         saved = true;
       }      
       v_free(&str);
@@ -486,7 +486,7 @@ void cmd_image_save(var_s *self, var_s *) {
     default:
       var = par_getvar_ptr();
       if (var->type == V_STR && !prog_error &&
-          !encode_png_file(var->v.p.ptr, image->_image, w, h)) {
+          !encode_png_file(v_strptr(var), image->_image, w, h)) {
         saved = true;
       } else if (!prog_error) {
         uint32_t offsetLeft = map_get_int(self, IMG_OFFSET_LEFT, 0);
@@ -669,7 +669,7 @@ extern "C" void v_create_image(var_p_t var) {
     eval(&arg);
     if (arg.type == V_STR && !prog_error) {
       dev_file_t file;
-      strlcpy(file.name, arg.v.p.ptr, sizeof(file.name));
+      strlcpy(file.name, v_strptr(&arg), sizeof(file.name));
       file.type = ft_stream;
       image = load_image(&file);
     } else if (arg.type == V_ARRAY && v_asize(&arg) > 0 && !prog_error) {
@@ -678,7 +678,7 @@ extern "C" void v_create_image(var_p_t var) {
         char **data = new char*[v_asize(&arg)];
         for (unsigned i = 0; i < v_asize(&arg); i++) {
           var_p_t elem = v_elem(&arg, i);
-          data[i] = elem->v.p.ptr;
+          data[i] = v_strptr(elem);
         }
         image = load_xpm_image(data);
         delete [] data;
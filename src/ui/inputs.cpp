@@ -57,7 +57,7 @@ int get_color(var_p_t value, int def) {
     }
   } else if (value != nullptr && value->type == V_STR &&
              value->v.p.length) {
-    const char *n = value->v.p.ptr;
+    const char *n = v_strptr(value);
     if (n[0] == '0' && n[1] == 'x' && n[2]) {
       result = strtol(n + 2, nullptr, 16);
     } else if (n[0] == '#' && n[1]) {
@@ -399,8 +399,8 @@ FormLabel::FormLabel(const char *caption, int x, int y, int w, int h) :
 bool FormLabel::updateUI(var_p_t form, var_p_t field) {
   bool updated = FormInput::updateUI(form, field);
   var_p_t var = map_get(field, FORM_INPUT_LABEL);
-  if (var != nullptr && var->type == V_STR && !_label.equals(var->v.p.ptr)) {
-    _label = var->v.p.ptr;
+  if (var != nullptr && var->type == V_STR && !_label.equals(v_strptr(var))) {
+    _label = v_strptr(var);
     updated = true;
   }
   return updated;
@@ -814,7 +814,7 @@ void ListModel::create(var_t *v) {
     fromArray(v);
   } else if (v->type == V_STR) {
     // construct from a string like "Easy|Medium|Hard"
-    const char *items = v->v.p.ptr;
+    const char *items = v_strptr(v);
     int len = items ? strlen(items) : 0;
     for (int i = 0; i < len; i++) {
       const char *c = strchr(items + i, '|');
@@ -836,7 +836,7 @@ void ListModel::fromArray(var_t *v) {
   for (unsigned i = 0; i < v_asize(v); i++) {
     var_t *el_p = v_elem(v, i);
     if (el_p->type == V_STR) {
-      _list.add(new strlib::String((const char *)el_p->v.p.ptr));
+      _list.add(new strlib::String((const char *)v_strptr(el_p)));
     } else if (el_p->type == V_INT) {
       char buff[40];
       sprintf(buff, VAR_INT_FMT, el_p->v.i);
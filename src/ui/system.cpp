@@ -144,6 +144,7 @@ System::~System() {
   _systemMenu = nullptr;
   _programSrc = nullptr;
   _editor = nullptr;
+  unit_cache_invalidate(nullptr);
 }
 
 bool System::execute(const char *bas) {
@@ -563,7 +564,7 @@ char *System::loadResource(const char *fileName) {
         } else {
           int len = var_p->v.p.length;
           buffer = (char *)malloc(len + 1);
-          memcpy(buffer, var_p->v.p.ptr, len);
+          memcpy(buffer, v_strptr(var_p), len);
           buffer[len] = '\0';
           _cache.add(fileName, buffer);
         }
@@ -53,7 +53,7 @@ StringList *get_items() {
       v_init(&arg);
       eval(&arg);
       if (arg.type == V_STR && !prog_error) {
-        items->add(new String(arg.v.p.ptr));
+        items->add(new String(v_strptr(&arg)));
       }
       v_free(&arg);
       break;
@@ -174,7 +174,7 @@ void cmd_window_message(var_s *self, var_s *) {
   v_init(&arg);
   eval(&arg);
   if (arg.type == V_STR && !prog_error) {
-    g_system->getOutput()->setStatus(arg.v.p.ptr);
+    g_system->getOutput()->setStatus(v_strptr(&arg));
   }
   v_free(&arg);
 }